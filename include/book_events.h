@@ -0,0 +1,81 @@
+#ifndef BOOK_EVENTS_H
+#define BOOK_EVENTS_H
+
+#include "order.h"
+#include <cstdint>
+#include <type_traits>
+
+// Typed engine events delivered synchronously to BasicOrderBook<Listener>.
+// All events are PODs passed by const reference; nothing is allocated to
+// dispatch them. Prices are integer ticks.
+
+struct OrderAcceptedEvent {
+    int         id;
+    OrderSide   side;
+    OrderType   type;
+    TimeInForce tif;
+    Price       priceTicks;  // 0 for MARKET
+    int         qty;
+};
+
+struct FillEvent {
+    int       makerId;
+    int       takerId;
+    OrderSide takerSide;
+    Price     priceTicks;    // maker's price
+    int       qty;
+    int       makerLeavesQty; // still resting after this fill
+    int       takerLeavesQty; // still unmatched after this fill
+};
+
+enum class DoneReason : uint8_t {
+    Filled,     // fully executed
+    Cancelled,  // cancel, or modify to qty <= 0
+    Expired,    // IOC/MARKET remainder dropped (or nothing to do)
+    Killed,     // FOK could not be fully filled
+};
+
+struct OrderDoneEvent {
+    int        id;
+    DoneReason reason;
+    int        unfilledQty;  // quantity that will never execute
+};
+
+struct LevelChangedEvent {
+    OrderSide side;
+    Price     priceTicks;
+    int       totalQty;      // 0 => level removed
+    int       orders;
+};
+
+struct TobChangedEvent {
+    bool  hasBid;
+    bool  hasAsk;
+    Price bidPx;             // valid iff hasBid
+    int   bidQty;
+    Price askPx;             // valid iff hasAsk
+    int   askQty;
+};
+
+static_assert(std::is_trivially_copyable_v<FillEvent> && std::is_standard_layout_v<FillEvent>);
+static_assert(std::is_trivially_copyable_v<TobChangedEvent> && std::is_standard_layout_v<TobChangedEvent>);
+
+// Base listener: ignores everything. Derive from it and hide the hooks you
+// need (no virtuals; the book is templated on the concrete type, so calls are
+// statically bound and inlined). Events are delivered, in the order they
+// happened, only after the operation that raised them has been fully applied,
+// so reads from a hook see the book as of the end of that operation. Handlers
+// may call addOrder/cancelOrder/modifyOrder on the same book: those are queued
+// and run, in order, once the hooks for the current operation have returned.
+// An exception thrown by a hook propagates out of the book call that was
+// dispatching; that call's undelivered events and queued calls are dropped and
+// the book stays usable.
+struct NullListener {
+    void onOrderAccepted(const OrderAcceptedEvent&) {}
+    void onFill(const FillEvent&) {}
+    void onOrderDone(const OrderDoneEvent&) {}
+    void onLevelChanged(const LevelChangedEvent&) {}
+    void onTobChanged(const TobChangedEvent&) {}
+};
+
+#endif // BOOK_EVENTS_H
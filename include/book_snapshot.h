@@ -0,0 +1,29 @@
+#ifndef BOOK_SNAPSHOT_H
+#define BOOK_SNAPSHOT_H
+
+#include "order.h"
+#include <cstdint>
+
+// Fixed-size, trivially copyable view of the top of the book.
+// Prices are integer ticks; only the first bidLevels/askLevels entries are valid.
+constexpr int kSnapshotDepth = 10;
+
+struct BookLevel {
+    Price   priceTicks{0};
+    int32_t qty{0};
+    int32_t orders{0};
+};
+
+struct BookSnapshot {
+    uint64_t  eventSeq{0};   // book-changing events applied when captured
+    Price     bestBidPx{0};  // valid iff bidLevels > 0
+    int32_t   bestBidQty{0};
+    int32_t   bidLevels{0};
+    Price     bestAskPx{0};  // valid iff askLevels > 0
+    int32_t   bestAskQty{0};
+    int32_t   askLevels{0};
+    BookLevel bids[kSnapshotDepth]; // best first
+    BookLevel asks[kSnapshotDepth]; // best first
+};
+
+#endif // BOOK_SNAPSHOT_H
@@ -0,0 +1,126 @@
+#ifndef GATEWAY_PROTOCOL_H
+#define GATEWAY_PROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Compact binary order-entry protocol spoken by orderbook_gateway.
+// Localhost only, so fields are in host byte order. Every frame starts with
+// a MsgHeader whose `length` covers the whole frame (header included).
+//
+// Client -> gateway: NewOrder, Cancel, Modify
+// Gateway -> client: Ack (exactly one Ack or Reject per request), Fill
+namespace gw {
+
+enum class MsgType : uint8_t {
+    NewOrder = 1,
+    Cancel   = 2,
+    Modify   = 3,
+    Ack      = 10,
+    Fill     = 11,
+    Reject   = 12,
+};
+
+enum class RejectReason : uint8_t {
+    UnknownOrder = 1, // cancel/modify for a clOrdId that is not resting
+    DuplicateId  = 2, // NewOrder reused a live clOrdId
+    BadQuantity  = 3,
+    BadMessage   = 4,
+};
+
+enum class Liquidity : uint8_t { Maker = 1, Taker = 2 };
+
+#pragma pack(push, 1)
+struct MsgHeader {
+    uint16_t length;
+    MsgType  type;
+    uint8_t  reserved;
+};
+
+struct NewOrderMsg {
+    MsgHeader hdr;
+    uint64_t  clOrdId;     // unique per connection
+    int64_t   priceTicks;  // ignored for MARKET
+    int32_t   quantity;
+    uint8_t   side;        // OrderSide
+    uint8_t   type;        // OrderType
+    uint8_t   tif;         // TimeInForce
+    uint8_t   pad;
+};
+
+struct CancelMsg {
+    MsgHeader hdr;
+    uint64_t  clOrdId;
+};
+
+struct ModifyMsg {
+    MsgHeader hdr;
+    uint64_t  clOrdId;
+    int64_t   priceTicks;
+    int32_t   quantity;    // <= 0 cancels
+};
+
+struct AckMsg {
+    MsgHeader hdr;
+    uint64_t  clOrdId;
+    int32_t   orderId;     // engine order id
+    int32_t   leavesQty;   // quantity resting after the request (0 = done)
+    MsgType   request;     // which request this acknowledges
+};
+
+struct FillMsg {
+    MsgHeader hdr;
+    uint64_t  clOrdId;
+    int64_t   priceTicks;
+    int32_t   quantity;
+    int32_t   leavesQty;
+    Liquidity liquidity;
+};
+
+struct RejectMsg {
+    MsgHeader    hdr;
+    uint64_t     clOrdId;
+    MsgType      request;
+    RejectReason reason;
+};
+#pragma pack(pop)
+
+constexpr size_t kMaxMsgSize = sizeof(NewOrderMsg) > sizeof(FillMsg) ? sizeof(NewOrderMsg) : sizeof(FillMsg);
+
+template<class Msg>
+inline Msg makeMsg(MsgType t) {
+    Msg m{};
+    m.hdr.length = static_cast<uint16_t>(sizeof(Msg));
+    m.hdr.type   = t;
+    return m;
+}
+
+// Expected frame size for a message type (0 if unknown)
+inline size_t msgSize(MsgType t) {
+    switch (t) {
+        case MsgType::NewOrder: return sizeof(NewOrderMsg);
+        case MsgType::Cancel:   return sizeof(CancelMsg);
+        case MsgType::Modify:   return sizeof(ModifyMsg);
+        case MsgType::Ack:      return sizeof(AckMsg);
+        case MsgType::Fill:     return sizeof(FillMsg);
+        case MsgType::Reject:   return sizeof(RejectMsg);
+    }
+    return 0;
+}
+
+template<class Msg>
+inline void appendMsg(std::string& buf, const Msg& m) {
+    buf.append(reinterpret_cast<const char*>(&m), sizeof(Msg));
+}
+
+template<class Msg>
+inline Msg readMsg(const char* p) {
+    Msg m;
+    std::memcpy(&m, p, sizeof(Msg));
+    return m;
+}
+
+} // namespace gw
+
+#endif // GATEWAY_PROTOCOL_H
@@ -0,0 +1,106 @@
+#ifndef MD_SHM_H
+#define MD_SHM_H
+
+#include "book_snapshot.h"
+#include "seqlock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Shared-memory market data: one writer (the engine) and any number of reader
+// processes on the same host. Top-of-book + depth live in a seqlock slot; trades
+// go into a sequence-numbered ring. Nothing on the publish path makes a syscall.
+
+constexpr uint64_t kMdMagic     = 0x4f424d4453484d31ULL; // "OBMDSHM1"
+constexpr uint32_t kMdVersion   = 1;
+constexpr uint64_t kMdTradeRing = 4096;                  // power of two
+static_assert((kMdTradeRing & (kMdTradeRing - 1)) == 0, "trade ring must be a power of two");
+constexpr int      kMdReadSpins = 1 << 16;               // retries before a reader gives up on a slot
+
+struct MdTrade {
+    uint64_t seq{0};          // 0-based trade sequence number
+    Price    priceTicks{0};
+    int32_t  qty{0};
+    int32_t  buyId{0};
+    int32_t  sellId{0};
+    int32_t  pad{0};
+};
+
+struct MdShmLayout {
+    std::atomic<uint64_t> magic;             // written last by the publisher
+    uint32_t version;
+    uint32_t depth;                          // levels published per side (<= kSnapshotDepth)
+    int64_t  tickScale;
+    uint64_t tradeRing;
+    std::atomic<uint32_t> live;              // 1 while the publisher is attached
+
+    alignas(64) Seqlock<BookSnapshot> book;
+    alignas(64) std::atomic<uint64_t> tradeCount; // trades published so far
+    alignas(64) Seqlock<MdTrade> trades[kMdTradeRing];
+};
+
+// Writer: creates (or replaces) the segment and owns it
+class MdPublisher {
+public:
+    MdPublisher() = default;
+    ~MdPublisher();
+    MdPublisher(const MdPublisher&) = delete;
+    MdPublisher& operator=(const MdPublisher&) = delete;
+
+    // name is a POSIX shm name, e.g. "/orderbook_md". Returns false on failure.
+    bool open(const std::string& name, int64_t tickScale, int depth = kSnapshotDepth);
+    void close();
+    bool isOpen() const { return shm_ != nullptr; }
+    int  depth() const { return depth_; }
+
+    void publishBook(const BookSnapshot& s) { shm_->book.store(s); }
+    void publishTrade(Price pxTicks, int qty, int buyId, int sellId) {
+        uint64_t n = shm_->tradeCount.load(std::memory_order_relaxed);
+        shm_->trades[n & (kMdTradeRing - 1)].store(MdTrade{n, pxTicks, qty, buyId, sellId, 0});
+        shm_->tradeCount.store(n + 1, std::memory_order_release);
+    }
+
+private:
+    MdShmLayout* shm_{nullptr};
+    std::string  name_;
+    int          depth_{kSnapshotDepth};
+};
+
+// Reader: maps an existing segment read-only
+class MdReader {
+public:
+    MdReader() = default;
+    ~MdReader();
+    MdReader(const MdReader&) = delete;
+    MdReader& operator=(const MdReader&) = delete;
+
+    bool open(const std::string& name); // false if missing or not a v1 segment
+    void close();
+    bool isOpen() const { return shm_ != nullptr; }
+
+    int64_t tickScale() const { return shm_->tickScale; }
+    int     depth() const { return static_cast<int>(shm_->depth); }
+    bool    publisherLive() const { return shm_->live.load(std::memory_order_acquire) != 0; }
+
+    // Consistent copy of the latest book; retries while a write is in flight.
+    // False if none was had within kMdReadSpins tries, or the publisher detached
+    // with the slot mid-write (a writer that dies there never finishes it).
+    bool readBook(BookSnapshot& out) const;
+    // Changes whenever the book slot is rewritten (cheap change detection)
+    uint64_t bookVersion() const { return shm_->book.version(); }
+
+    // Copy up to maxOut trades published since the last call. Trades overwritten
+    // before this reader got to them are skipped and added to `lost`. Stops
+    // early, to resume on the next call, at a slot it cannot read (as readBook).
+    size_t pollTrades(MdTrade* out, size_t maxOut, uint64_t& lost);
+
+    // Skip any backlog and start from the next trade published
+    void seekToLatest() { nextTrade_ = shm_->tradeCount.load(std::memory_order_acquire); }
+
+private:
+    const MdShmLayout* shm_{nullptr};
+    uint64_t nextTrade_{0};
+};
+
+#endif // MD_SHM_H
@@ -38,6 +38,17 @@ struct Trade {
     int         quantity{0};
     int         buyId{0};
     int         sellId{0};
+    Price       priceTicks{0}; // raw integer ticks (for in-process consumers)
+};
+
+// Where a watched order sits in its price level's FIFO
+struct QueuePosition {
+    bool      resting{false};      // false until it rests / once it leaves the book
+    OrderSide side{OrderSide::BUY};
+    Price     priceTicks{0};
+    int       qtyAhead{0};         // resting quantity in front of it
+    int       rank{0};             // orders in front of it (0 = first in line)
+    int       remainingQty{0};
 };
 
 #endif // ORDER_H
@@ -2,6 +2,9 @@
 #define ORDERBOOK_H
 
 #include "order.h"
+#include "book_events.h"
+#include "book_snapshot.h"
+#include "seqlock.h"
 #include <map>
 #include <list>
 #include <tuple>
@@ -10,16 +13,35 @@
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <memory>
+#include <functional>
+#include <type_traits>
 
-class OrderBook {
+class MdPublisher;
+
+// Listener receives engine events (see book_events.h). The default
+// NullListener compiles every hook away; use OrderBook for that case.
+template<class Listener = NullListener>
+class BasicOrderBook {
 public:
-    explicit OrderBook(int64_t tickScale = 100); // e.g., 100 = cents
-    ~OrderBook();
+    explicit BasicOrderBook(int64_t tickScale = 100); // e.g., 100 = cents
+    explicit BasicOrderBook(Listener& listener, int64_t tickScale = 100);
+    ~BasicOrderBook();
+
+    // Events go to `l` (not owned; nullptr = none)
+    void setListener(Listener* l) { listener_ = l; }
+    // Room for events buffered during one operation (default kEventReserve:
+    // each maker swept adds a fill and usually a done) and for calls queued by
+    // hooks (default kCallReserve). Past that a buffer grows (amortized) until
+    // it fits, then keeps its capacity.
+    void reserveListenerBuffers(size_t events, size_t calls);
 
     // Ingest one line (human-readable or compact CSV). Returns true if processed.
     bool addFromLine(const std::string& line);
 
-    // Direct API
+    // Direct API. Called from inside a listener hook these are queued (and
+    // return true); they run in order once the current operation's hooks have
+    // returned, stamped with that operation's timestamp.
     bool addOrder(const Order& o);
     bool cancelOrder(int orderId, const std::string& timestamp = "");
     bool modifyOrder(int orderId, Price newPxTicks, int newQty, const std::string& timestamp = "");
@@ -28,6 +50,34 @@ public:
     bool   bestBidAsk(double& bid, int& bidQty, double& ask, int& askQty) const;
     double midPrice() const;
     double spread() const;
+    int    restingQty(int orderId) const; // 0 if not resting
+    size_t orderCount() const { return idIndex_.size(); }
+
+    // Trades recorded since construction (or the last clearTrades())
+    const std::vector<Trade>& trades() const { return trades_; }
+    void   clearTrades() { trades_.clear(); }
+
+    // Queue position of watched orders, maintained incrementally as fills,
+    // cancels and modifies remove quantity ahead (no per-query list walk).
+    // An id may be watched before the order arrives. The watch is dropped
+    // after the final resting=false callback (filled or cancelled), or when
+    // the order arrives and does not rest; otherwise call unwatchOrder.
+    void   watchOrder(int orderId);
+    void   unwatchOrder(int orderId);
+    bool   queuePosition(int orderId, QueuePosition& out) const; // false if not watched
+    void   setQueuePositionCallback(std::function<void(int orderId, const QueuePosition&)> cb);
+
+    // Fixed-depth copy of the top of the book (depth clamped to kSnapshotDepth)
+    void   fillSnapshot(BookSnapshot& out, int depth = kSnapshotDepth) const;
+
+    // Concurrent reads. Everything else on OrderBook is single-threaded; these
+    // let other threads see a consistent top-of-book + depth without locks.
+    // Enable before starting readers. perEvent=false publishes only on
+    // publishSnapshot(), e.g. once per batch.
+    void   enableConcurrentReads(bool perEvent = true);
+    void   publishSnapshot();                        // matcher thread only
+    bool   readSnapshot(BookSnapshot& out) const;    // any thread; false if not enabled
+    uint64_t snapshotVersion() const;                // any thread; changes on every publish
 
     // Outputs
     void   printBook(std::ostream& os = std::cout, int depth = 10) const;
@@ -38,22 +88,40 @@ public:
     void   setTradesCsvPath(const std::string& path);
     void   setQuotesCsvPath(const std::string& path);
     void   setSnapshotCadence(size_t everyN, const std::string& dir);
+    // Publish book + trades to shared memory (not owned; nullptr detaches)
+    void   setMarketDataPublisher(MdPublisher* pub);
 
     // Tick accounting (call after each processed input event)
     void   onTick(const std::string& timestamp = "");
 
 private:
+    static constexpr bool   kHasListener = !std::is_same_v<Listener, NullListener>;
+    static constexpr size_t kEventReserve = 256; // ~10x the worst seen in the test streams
+    static constexpr size_t kCallReserve  = 64;
+
+    struct WatchState {
+        int           id{0};
+        uint64_t      queueSeq{0}; // arrival order at the level while resting
+        QueuePosition pos;
+    };
+
     struct LevelInfo {
         std::list<Order> orders; // FIFO
         int              totalQty{0};
+        std::vector<WatchState*> watchers; // watched orders resting here, in queue order
     };
 
     using BookSide = std::map<Price, LevelInfo>; // asks ascending; bids ascending (best = rbegin)
     BookSide asks_;
     BookSide bids_;
 
-    // id -> (side, price, iterator into Level)
-    std::unordered_map<int, std::tuple<OrderSide,Price,std::list<Order>::iterator>> idIndex_;
+    // id -> (side, price, iterator into Level, queue sequence number)
+    std::unordered_map<int, std::tuple<OrderSide,Price,std::list<Order>::iterator,uint64_t>> idIndex_;
+    uint64_t nextQueueSeq_{0};
+
+    // Queue-position tracking (node-based map: WatchState* stays valid)
+    std::unordered_map<int, WatchState> watched_;
+    std::function<void(int, const QueuePosition&)> queueCallback_;
 
     // Trades (also persisted to CSV)
     std::vector<Trade> trades_;
@@ -76,11 +144,51 @@ private:
     std::ofstream tradesCsv_;
     std::ofstream quotesCsv_;
 
+    // Shared-memory market data (optional)
+    MdPublisher* mdPublisher_{nullptr};
+    uint64_t     eventSeq_{0}; // book-changing events seen by emitQuoteIfChanged
+
+    // Snapshot slot for concurrent readers (allocated by enableConcurrentReads)
+    std::unique_ptr<Seqlock<BookSnapshot>> liveSnapshot_;
+    bool         liveSnapshotPerEvent_{false};
+
     // Snapshots
     size_t  snapshotEvery_{0};
     size_t  tick_{0};
     std::string snapshotDir_;
 
+    // Listener, events raised by the current operation (delivered once it has
+    // been fully applied) and calls hooks made while we were dispatching
+    struct BufferedEvent {
+        enum Kind : uint8_t { Accepted, Fill, Done, Level, Tob } kind;
+        union {
+            OrderAcceptedEvent accepted;
+            FillEvent          fill;
+            OrderDoneEvent     done;
+            LevelChangedEvent  level;
+            TobChangedEvent    tob;
+        };
+        BufferedEvent(const OrderAcceptedEvent& e) : kind(Accepted), accepted(e) {}
+        BufferedEvent(const FillEvent& e)          : kind(Fill), fill(e) {}
+        BufferedEvent(const OrderDoneEvent& e)     : kind(Done), done(e) {}
+        BufferedEvent(const LevelChangedEvent& e)  : kind(Level), level(e) {}
+        BufferedEvent(const TobChangedEvent& e)    : kind(Tob), tob(e) {}
+    };
+    struct PendingOp {    // POD: queuing a call never allocates beyond the vector
+        enum Kind : uint8_t { Add, Cancel, Modify } kind;
+        OrderSide   side;       // Add only
+        OrderType   type;       // Add only
+        TimeInForce tif;        // Add only
+        int         id;
+        Price       priceTicks; // Add / Modify
+        int         qty;        // Add / Modify
+    };
+    Listener*                  listener_{nullptr};
+    bool                       dispatching_{false};
+    std::vector<BufferedEvent> events_;
+    std::vector<PendingOp>     pending_;
+    static_assert(std::is_trivially_copyable_v<PendingOp>);
+
     // Auto id if feed doesn't provide one
     int nextOrderId_{1};
 
@@ -92,14 +200,37 @@ private:
     bool match(Order& incoming);
     bool canFullyFill(OrderSide side, std::optional<Price> limitPx, int qty) const;
 
+    // Operations behind the public API (which adds listener re-entrancy handling)
+    bool addOrderImpl(const Order& o);
+    bool cancelOrderImpl(int orderId, const std::string& timestamp);
+    bool modifyOrderImpl(int orderId, Price newPxTicks, int newQty, const std::string& timestamp);
+    void finishOp(const std::string& timestamp);
+
+    // Listener events (no-ops for NullListener). Buffered, then delivered by
+    // flushEvents() once the book is consistent again.
+    template<class Event>
+    void raise(const Event& e);
+    void notifyLevel(OrderSide side, Price px, const LevelInfo& lvl); // call before erasing an empty level
+    void notifyDone(int id, DoneReason why, int unfilledQty);
+    void flushEvents();
+
     // Helpers
     void restOrder(const Order& o);
     void eraseLevelIfEmpty(OrderSide side, Price px);
     void updateBestOnAdd(OrderSide side, Price px);
     void updateBestOnChange();
     void emitQuoteIfChanged(const std::string& ts);
+    void publishBookState();
     void logTrade(const std::string& ts, Price pxTicks, int qty, int buyId, int sellId);
 
+    // Queue-position maintenance (no-ops unless the level has watchers)
+    void queueOnRest(LevelInfo& lvl, const Order& o, uint64_t queueSeq);
+    void queueOnRemove(LevelInfo& lvl, int orderId, uint64_t queueSeq, int qty);
+    void queueOnFill(LevelInfo& lvl, int makerId, int traded, bool makerDone);
+    void notifyQueue(const WatchState& w);
+    void detachWatch(WatchState& w);
+    void dropWatchIfGone(int orderId);
+
     // Parsing
     bool parseHumanLine(const std::string& line, Order& out, bool& isCancel, bool& isModify,
                         int& modId, Price& modPxTicks, int& modQty);
@@ -114,4 +245,7 @@ private:
     Price toTicks(double px) const;
 };
 
+extern template class BasicOrderBook<NullListener>;
+using OrderBook = BasicOrderBook<>;
+
 #endif // ORDERBOOK_H
@@ -0,0 +1,926 @@
+#ifndef ORDERBOOK_IMPL_H
+#define ORDERBOOK_IMPL_H
+
+// Member definitions for BasicOrderBook<Listener>. Include this (instead of
+// orderbook.h alone) when instantiating the book with your own listener type;
+// BasicOrderBook<NullListener> is prebuilt in src/orderbook.cpp.
+
+#include "orderbook.h"
+#include "md_shm.h"
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <cmath>
+
+namespace orderbook_detail {
+inline bool safe_stoi(const std::string& s, int& out) {
+    try { size_t i=0; int v = std::stoi(s, &i); if (i != s.size()) return false; out = v; return true; }
+    catch (...) { return false; }
+}
+inline bool safe_stod(const std::string& s, double& out) {
+    try { size_t i=0; double v = std::stod(s, &i); if (i != s.size()) return false; out = v; return true; }
+    catch (...) { return false; }
+}
+} // namespace orderbook_detail
+
+template<class Listener>
+BasicOrderBook<Listener>::BasicOrderBook(int64_t tickScale) : tickScale_(tickScale) {
+    reserveListenerBuffers(kEventReserve, kCallReserve);
+}
+template<class Listener>
+BasicOrderBook<Listener>::BasicOrderBook(Listener& listener, int64_t tickScale)
+    : BasicOrderBook(tickScale) {
+    listener_ = &listener;
+}
+template<class Listener>
+BasicOrderBook<Listener>::~BasicOrderBook() {
+    if (tradesCsv_.is_open()) tradesCsv_.close();
+    if (quotesCsv_.is_open()) quotesCsv_.close();
+}
+
+template<class Listener>
+Price BasicOrderBook<Listener>::toTicks(double px) const {
+    // round to nearest tick
+    return static_cast<Price>(std::llround(px * static_cast<double>(tickScale_)));
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::setTradesCsvPath(const std::string& path) {
+    tradesCsvPath_ = path;
+    if (!path.empty()) {
+        tradesCsv_.open(path, std::ios::out);
+        if (tradesCsv_.is_open()) {
+            tradesCsv_ << "timestamp,price,qty,buy_id,sell_id\n";
+        }
+    }
+}
+template<class Listener>
+void BasicOrderBook<Listener>::setQuotesCsvPath(const std::string& path) {
+    quotesCsvPath_ = path;
+    if (!path.empty()) {
+        quotesCsv_.open(path, std::ios::out);
+        if (quotesCsv_.is_open()) {
+            quotesCsv_ << "timestamp,best_bid,bid_qty,best_ask,ask_qty,spread,mid\n";
+        }
+    }
+}
+template<class Listener>
+void BasicOrderBook<Listener>::setSnapshotCadence(size_t everyN, const std::string& dir) {
+    snapshotEvery_ = everyN;
+    snapshotDir_   = dir;
+    if (snapshotEvery_ > 0 && !snapshotDir_.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(snapshotDir_, ec);
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::setMarketDataPublisher(MdPublisher* pub) {
+    mdPublisher_ = (pub && pub->isOpen()) ? pub : nullptr;
+    if (mdPublisher_) {
+        BookSnapshot s;
+        fillSnapshot(s, mdPublisher_->depth());
+        mdPublisher_->publishBook(s);
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::enableConcurrentReads(bool perEvent) {
+    if (!liveSnapshot_) liveSnapshot_ = std::make_unique<Seqlock<BookSnapshot>>();
+    liveSnapshotPerEvent_ = perEvent;
+    publishSnapshot();
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::publishSnapshot() {
+    if (!liveSnapshot_) return;
+    BookSnapshot s;
+    fillSnapshot(s, kSnapshotDepth);
+    liveSnapshot_->store(s);
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::readSnapshot(BookSnapshot& out) const {
+    if (!liveSnapshot_) return false;
+    out = liveSnapshot_->load();
+    return true;
+}
+
+template<class Listener>
+uint64_t BasicOrderBook<Listener>::snapshotVersion() const {
+    return liveSnapshot_ ? liveSnapshot_->version() : 0;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::addFromLine(const std::string& line) {
+    if (line.empty()) return false;
+    // Skip blanks and comments starting with '#'
+    size_t pos = line.find_first_not_of(" \t\r\n");
+    if (pos == std::string::npos) return false;
+    if (line[pos] == '#') return false;
+
+    Order o;
+    bool isCancel=false, isModify=false;
+    int modId=0, modQty=0;
+    Price modPxTicks=0;
+
+    if (!parseHumanLine(line, o, isCancel, isModify, modId, modPxTicks, modQty) &&
+        !parseCompactCsvLine(line, o, isCancel, isModify, modId, modPxTicks, modQty)) {
+        // Unrecognized or malformed line — ignore safely
+        return false;
+    }
+    if (isCancel)  return cancelOrder(modId, o.timestamp);
+    if (isModify)  return modifyOrder(modId, modPxTicks, modQty, o.timestamp);
+    return addOrder(o);
+}
+
+// With a listener, each operation runs to completion before any hook sees its
+// events; calls made from inside a hook are queued (no PendingOp is built
+// otherwise) and applied in order after the hooks return.
+template<class Listener>
+bool BasicOrderBook<Listener>::addOrder(const Order& o) {
+    if constexpr (kHasListener) {
+        if (dispatching_) {
+            pending_.push_back(PendingOp{PendingOp::Add, o.side, o.type, o.tif, o.id, o.priceTicks, o.quantity});
+            return true;
+        }
+        bool ok = addOrderImpl(o);
+        finishOp(o.timestamp);
+        return ok;
+    } else {
+        return addOrderImpl(o);
+    }
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::cancelOrder(int orderId, const std::string& ts) {
+    if constexpr (kHasListener) {
+        if (dispatching_) {
+            pending_.push_back(PendingOp{PendingOp::Cancel, OrderSide::BUY, OrderType::LIMIT, TimeInForce::GTC,
+                                         orderId, 0, 0});
+            return true;
+        }
+        bool ok = cancelOrderImpl(orderId, ts);
+        finishOp(ts);
+        return ok;
+    } else {
+        return cancelOrderImpl(orderId, ts);
+    }
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::modifyOrder(int orderId, Price newPxTicks, int newQty, const std::string& ts) {
+    if constexpr (kHasListener) {
+        if (dispatching_) {
+            pending_.push_back(PendingOp{PendingOp::Modify, OrderSide::BUY, OrderType::LIMIT, TimeInForce::GTC,
+                                         orderId, newPxTicks, newQty});
+            return true;
+        }
+        bool ok = modifyOrderImpl(orderId, newPxTicks, newQty, ts);
+        finishOp(ts);
+        return ok;
+    } else {
+        return modifyOrderImpl(orderId, newPxTicks, newQty, ts);
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::reserveListenerBuffers(size_t events, size_t calls) {
+    if constexpr (kHasListener) {
+        events_.reserve(events);
+        pending_.reserve(calls);
+    } else {
+        (void)events; (void)calls;
+    }
+}
+
+// Deliver the operation's events, then apply whatever the hooks queued, in
+// order (applying one may queue more), delivering each one's events in turn.
+// Queued calls carry no timestamp of their own; they run with `ts`.
+// If a hook throws, the exception propagates and the rest of this dispatch is
+// dropped; the guard resets the state so later calls still run.
+template<class Listener>
+void BasicOrderBook<Listener>::finishOp(const std::string& ts) {
+    struct Reset {
+        BasicOrderBook& book;
+        ~Reset() {
+            book.events_.clear();
+            book.pending_.clear();
+            book.dispatching_ = false;
+        }
+    } reset{*this};
+    dispatching_ = true;
+    flushEvents();
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        const PendingOp op = pending_[i]; // copy: applying it may grow pending_
+        switch (op.kind) {
+            case PendingOp::Add:
+                addOrderImpl(Order(op.id, ts, op.side, op.type, op.tif, op.priceTicks, op.qty));
+                break;
+            case PendingOp::Cancel: cancelOrderImpl(op.id, ts); break;
+            case PendingOp::Modify: modifyOrderImpl(op.id, op.priceTicks, op.qty, ts); break;
+        }
+        flushEvents();
+    }
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::addOrderImpl(const Order& in) {
+    Order o = in;
+    if (o.id == 0) o.id = nextOrderId_++;
+    raise(OrderAcceptedEvent{o.id, o.side, o.type, o.tif,
+                             o.type == OrderType::MARKET ? 0 : o.priceTicks, o.quantity});
+    const int origQty = o.quantity;
+
+    bool rested = false;
+    if (o.type == OrderType::MARKET) {
+        if (o.side == OrderSide::BUY) match<OrderSide::BUY>(o);
+        else                          match<OrderSide::SELL>(o);
+    } else {
+        // LIMIT
+        if (o.side == OrderSide::BUY) match<OrderSide::BUY>(o);
+        else                          match<OrderSide::SELL>(o);
+        if (o.quantity > 0 && o.tif != TimeInForce::IOC && o.tif != TimeInForce::FOK) {
+            restOrder(o);
+            rested = true;
+        }
+    }
+
+    if (!rested) {
+        dropWatchIfGone(o.id); // watched before arrival but never rested
+        if (o.quantity <= 0 && origQty > 0)                   notifyDone(o.id, DoneReason::Filled, 0);
+        else if (o.tif == TimeInForce::FOK && o.quantity > 0) notifyDone(o.id, DoneReason::Killed, o.quantity);
+        else                                                  notifyDone(o.id, DoneReason::Expired, std::max(o.quantity, 0));
+    }
+    emitQuoteIfChanged(o.timestamp);
+    return true;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::cancelOrderImpl(int orderId, const std::string& ts) {
+    auto it = idIndex_.find(orderId);
+    if (it == idIndex_.end()) return false;
+    auto [side, px, lit, queueSeq] = it->second;
+    auto& book = (side == OrderSide::BUY) ? bids_ : asks_;
+    auto b = book.find(px);
+    if (b == book.end()) return false;
+    int qty = lit->quantity;
+    queueOnRemove(b->second, orderId, queueSeq, qty);
+    b->second.totalQty -= qty;
+    b->second.orders.erase(lit);
+    idIndex_.erase(it);
+    notifyLevel(side, px, b->second);
+    notifyDone(orderId, DoneReason::Cancelled, qty);
+    dropWatchIfGone(orderId);
+    if (b->second.orders.empty()) eraseLevelIfEmpty(side, px);
+    updateBestOnChange();
+    emitQuoteIfChanged(ts);
+    return true;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::modifyOrderImpl(int orderId, Price newPxTicks, int newQty, const std::string& ts) {
+    if (newQty <= 0) return cancelOrderImpl(orderId, ts);
+
+    auto itIdx = idIndex_.find(orderId);
+    if (itIdx == idIndex_.end()) return false;
+
+    auto [side, oldPx, lit, queueSeq] = itIdx->second;
+    auto& fromBook = (side == OrderSide::BUY) ? bids_ : asks_;
+    auto fb = fromBook.find(oldPx);
+    if (fb == fromBook.end()) return false;
+
+    // 1) Copy the order (value type) out
+    Order o = *lit;
+
+    // 2) Drop the old index entry BEFORE we erase the list node
+    idIndex_.erase(itIdx);
+
+    // 3) Remove from old level (priority is lost even if only qty changes)
+    queueOnRemove(fb->second, orderId, queueSeq, o.quantity);
+    fb->second.totalQty -= o.quantity;
+    fb->second.orders.erase(lit);
+    notifyLevel(side, oldPx, fb->second);
+    if (fb->second.orders.empty()) eraseLevelIfEmpty(side, oldPx);
+
+    // 4) Apply new fields
+    o.priceTicks = newPxTicks;
+    o.quantity   = newQty;
+
+    // 5) Try to match at the new price
+    if (side == OrderSide::BUY) match<OrderSide::BUY>(o);
+    else                        match<OrderSide::SELL>(o);
+
+    // 6) If still has remainder, re-rest and re-index
+    if (o.quantity > 0) {
+        restOrder(o);
+    } else {
+        notifyDone(orderId, DoneReason::Filled, 0);
+        dropWatchIfGone(orderId);
+    }
+
+    updateBestOnChange();
+    emitQuoteIfChanged(ts);
+    return true;
+}
+
+
+template<class Listener>
+bool BasicOrderBook<Listener>::bestBidAsk(double& bid, int& bidQty, double& ask, int& askQty) const {
+    if (bids_.empty() || asks_.empty()) return false;
+    bid = fromTicks(bestBidPx_); bidQty = bestBidQty_;
+    ask = fromTicks(bestAskPx_); askQty = bestAskQty_;
+    return true;
+}
+
+template<class Listener>
+double BasicOrderBook<Listener>::midPrice() const {
+    if (bids_.empty() || asks_.empty()) return std::numeric_limits<double>::quiet_NaN();
+    return (fromTicks(bestBidPx_) + fromTicks(bestAskPx_)) * 0.5;
+}
+
+template<class Listener>
+double BasicOrderBook<Listener>::spread() const {
+    if (bids_.empty() || asks_.empty()) return std::numeric_limits<double>::quiet_NaN();
+    return fromTicks(bestAskPx_ - bestBidPx_);
+}
+
+template<class Listener>
+int BasicOrderBook<Listener>::restingQty(int orderId) const {
+    auto it = idIndex_.find(orderId);
+    if (it == idIndex_.end()) return 0;
+    return std::get<2>(it->second)->quantity;
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::watchOrder(int orderId) {
+    auto [wit, inserted] = watched_.try_emplace(orderId);
+    if (!inserted) return;
+    WatchState& w = wit->second;
+    w.id = orderId;
+
+    auto it = idIndex_.find(orderId);
+    if (it == idIndex_.end()) return; // starts tracking when it rests
+    auto [side, px, lit, queueSeq] = it->second;
+    auto& lvl = ((side == OrderSide::BUY) ? bids_ : asks_).find(px)->second;
+
+    // One-off walk to seed the position; incremental from here on
+    w.queueSeq = queueSeq;
+    w.pos = QueuePosition{true, side, px, 0, 0, lit->quantity};
+    for (auto o = lvl.orders.begin(); o != lit; ++o) {
+        w.pos.qtyAhead += o->quantity;
+        ++w.pos.rank;
+    }
+    auto at = std::lower_bound(lvl.watchers.begin(), lvl.watchers.end(), queueSeq,
+                               [](const WatchState* a, uint64_t seq) { return a->queueSeq < seq; });
+    lvl.watchers.insert(at, &w);
+    notifyQueue(w);
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::unwatchOrder(int orderId) {
+    auto wit = watched_.find(orderId);
+    if (wit == watched_.end()) return;
+    detachWatch(wit->second);
+    watched_.erase(wit);
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::queuePosition(int orderId, QueuePosition& out) const {
+    auto wit = watched_.find(orderId);
+    if (wit == watched_.end()) return false;
+    out = wit->second.pos;
+    return true;
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::setQueuePositionCallback(std::function<void(int orderId, const QueuePosition&)> cb) {
+    queueCallback_ = std::move(cb);
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::fillSnapshot(BookSnapshot& s, int depth) const {
+    depth = std::clamp(depth, 0, kSnapshotDepth);
+    s.eventSeq = eventSeq_;
+    s.bestBidPx = bids_.empty() ? 0 : bestBidPx_;
+    s.bestBidQty = bestBidQty_;
+    s.bestAskPx = asks_.empty() ? 0 : bestAskPx_;
+    s.bestAskQty = bestAskQty_;
+
+    int n = 0;
+    for (auto it = bids_.rbegin(); it != bids_.rend() && n < depth; ++it, ++n) {
+        s.bids[n] = BookLevel{it->first, it->second.totalQty, static_cast<int32_t>(it->second.orders.size())};
+    }
+    s.bidLevels = n;
+    n = 0;
+    for (auto it = asks_.begin(); it != asks_.end() && n < depth; ++it, ++n) {
+        s.asks[n] = BookLevel{it->first, it->second.totalQty, static_cast<int32_t>(it->second.orders.size())};
+    }
+    s.askLevels = n;
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::printTrades(std::ostream& os) const {
+    for (const auto& t : trades_) {
+        os << t.timestamp << " - " << t.quantity << " @ " << std::fixed << std::setprecision(2)
+           << t.price << " (BUY #" << t.buyId << " - SELL #" << t.sellId << ")\n";
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::dumpSnapshot(std::ostream& os, int depth) const {
+    os << "=== SNAPSHOT ===\n";
+    printBook(os, depth);
+    os << "================\n";
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::printBook(std::ostream& os, int depth) const {
+    os << "----- ORDER BOOK -----\n";
+    int printed = 0;
+    for (auto it = asks_.begin(); it != asks_.end() && printed < depth; ++it, ++printed) {
+        os << "ASK " << std::fixed << std::setprecision(2) << fromTicks(it->first)
+           << " x " << it->second.totalQty << "\n";
+    }
+    printed = 0;
+    for (auto it = bids_.rbegin(); it != bids_.rend() && printed < depth; ++it, ++printed) {
+        os << "BID " << std::fixed << std::setprecision(2) << fromTicks(it->first)
+           << " x " << it->second.totalQty << "\n";
+    }
+    if (!bids_.empty() && !asks_.empty()) {
+        os << "BestBid " << fromTicks(bestBidPx_) << " ("<< bestBidQty_ << "), "
+           << "BestAsk " << fromTicks(bestAskPx_) << " ("<< bestAskQty_ << ")"
+           << " | Spread " << spread() << " | Mid " << midPrice() << "\n";
+    } else {
+        os << "No full top-of-book.\n";
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::onTick(const std::string&) {
+    ++tick_;
+    if (snapshotEvery_ > 0 && tick_ % snapshotEvery_ == 0 && !snapshotDir_.empty()) {
+        std::ostringstream fn;
+        fn << snapshotDir_ << "/snapshot_" << std::setw(9) << std::setfill('0') << tick_ << ".txt";
+        std::ofstream out(fn.str());
+        if (out) dumpSnapshot(out);
+    }
+}
+
+// --------------- internals ---------------
+
+template<class Listener>
+void BasicOrderBook<Listener>::restOrder(const Order& o) {
+    auto& book = (o.side == OrderSide::BUY) ? bids_ : asks_;
+    auto& lvl  = book[o.priceTicks];
+    lvl.orders.emplace_back(o);
+    lvl.totalQty += o.quantity;
+    auto it = std::prev(lvl.orders.end());
+    uint64_t queueSeq = nextQueueSeq_++;
+    idIndex_[o.id] = {o.side, o.priceTicks, it, queueSeq};
+    if (!watched_.empty()) queueOnRest(lvl, o, queueSeq);
+    notifyLevel(o.side, o.priceTicks, lvl);
+    updateBestOnAdd(o.side, o.priceTicks);
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::eraseLevelIfEmpty(OrderSide side, Price px) {
+    auto& book = (side == OrderSide::BUY) ? bids_ : asks_;
+    auto it = book.find(px);
+    if (it != book.end() && it->second.orders.empty()) {
+        book.erase(it);
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::updateBestOnAdd(OrderSide, Price) { updateBestOnChange(); }
+
+template<class Listener>
+void BasicOrderBook<Listener>::updateBestOnChange() {
+    if (bids_.empty()) { bestBidPx_ = std::numeric_limits<Price>::min(); bestBidQty_=0; }
+    else { bestBidPx_ = bids_.rbegin()->first; bestBidQty_ = bids_.rbegin()->second.totalQty; }
+    if (asks_.empty()) { bestAskPx_ = std::numeric_limits<Price>::max(); bestAskQty_=0; }
+    else { bestAskPx_ = asks_.begin()->first; bestAskQty_ = asks_.begin()->second.totalQty; }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::emitQuoteIfChanged(const std::string& ts) {
+    ++eventSeq_;
+    publishBookState();
+    if (!quotesCsv_.is_open() && !(kHasListener && listener_)) return;
+    bool changed =
+        ((bids_.empty()) != (lastQuotedBid_ == std::numeric_limits<Price>::min())) ||
+        ((asks_.empty()) != (lastQuotedAsk_ == std::numeric_limits<Price>::max())) ||
+        (!bids_.empty() && (bestBidPx_ != lastQuotedBid_ || bestBidQty_ != lastQuotedBidQty_)) ||
+        (!asks_.empty() && (bestAskPx_ != lastQuotedAsk_ || bestAskQty_ != lastQuotedAskQty_));
+    if (!changed) return;
+
+    lastQuotedBid_ = bids_.empty() ? std::numeric_limits<Price>::min() : bestBidPx_;
+    lastQuotedBidQty_ = bestBidQty_;
+    lastQuotedAsk_ = asks_.empty() ? std::numeric_limits<Price>::max() : bestAskPx_;
+    lastQuotedAskQty_ = bestAskQty_;
+
+    raise(TobChangedEvent{!bids_.empty(), !asks_.empty(), bestBidPx_, bestBidQty_, bestAskPx_, bestAskQty_});
+    if (!quotesCsv_.is_open()) return;
+
+    double spr = spread();
+    double mid = midPrice();
+    quotesCsv_ << ts << ","
+               << (bids_.empty() ? std::string() : std::to_string(fromTicks(bestBidPx_))) << ","
+               << bestBidQty_ << ","
+               << (asks_.empty() ? std::string() : std::to_string(fromTicks(bestAskPx_))) << ","
+               << bestAskQty_ << ","
+               << (std::isnan(spr) ? std::string() : std::to_string(spr)) << ","
+               << (std::isnan(mid) ? std::string() : std::to_string(mid)) << "\n";
+}
+
+// Depth can move without the TOB moving, so snapshot consumers get every event
+template<class Listener>
+void BasicOrderBook<Listener>::publishBookState() {
+    bool live = liveSnapshot_ && liveSnapshotPerEvent_;
+    if (!mdPublisher_ && !live) return;
+    BookSnapshot s;
+    fillSnapshot(s, live ? kSnapshotDepth : mdPublisher_->depth());
+    if (live) liveSnapshot_->store(s);
+    if (mdPublisher_) {
+        s.bidLevels = std::min(s.bidLevels, mdPublisher_->depth());
+        s.askLevels = std::min(s.askLevels, mdPublisher_->depth());
+        mdPublisher_->publishBook(s);
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::logTrade(const std::string& ts, Price pxTicks, int qty, int buyId, int sellId) {
+    double px = fromTicks(pxTicks);
+    trades_.push_back(Trade{ts, px, qty, buyId, sellId, pxTicks});
+    if (mdPublisher_) mdPublisher_->publishTrade(pxTicks, qty, buyId, sellId);
+    if (tradesCsv_.is_open()) {
+        tradesCsv_ << ts << "," << px << "," << qty << "," << buyId << "," << sellId << "\n";
+    }
+}
+
+// Queue-position bookkeeping. Cost is O(watchers at the level), independent of
+// queue length. Callbacks run synchronously and must not modify the book.
+
+template<class Listener>
+void BasicOrderBook<Listener>::queueOnRest(LevelInfo& lvl, const Order& o, uint64_t queueSeq) {
+    auto wit = watched_.find(o.id);
+    if (wit == watched_.end()) return;
+    WatchState& w = wit->second;
+    // A duplicate id re-rests: the watch follows the newest order (as idIndex_
+    // does) and stays linked into exactly one level
+    detachWatch(w);
+    // Arrives at the back: everything already resting is ahead of it
+    w.queueSeq = queueSeq;
+    w.pos = QueuePosition{true, o.side, o.priceTicks, lvl.totalQty - o.quantity,
+                          static_cast<int>(lvl.orders.size()) - 1, o.quantity};
+    lvl.watchers.push_back(&w);
+    notifyQueue(w);
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::queueOnRemove(LevelInfo& lvl, int orderId, uint64_t queueSeq, int qty) {
+    if (lvl.watchers.empty()) return;
+    for (size_t i = 0; i < lvl.watchers.size(); ) {
+        WatchState* w = lvl.watchers[i];
+        if (w->queueSeq == queueSeq) {
+            w->pos.resting = false;
+            w->pos.qtyAhead = 0; w->pos.rank = 0; w->pos.remainingQty = 0;
+            lvl.watchers.erase(lvl.watchers.begin() + static_cast<std::ptrdiff_t>(i));
+            notifyQueue(*w);
+            continue;
+        }
+        if (w->queueSeq > queueSeq) {
+            w->pos.qtyAhead -= qty;
+            w->pos.rank     -= 1;
+            notifyQueue(*w);
+        }
+        ++i;
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::queueOnFill(LevelInfo& lvl, int makerId, int traded, bool makerDone) {
+    if (lvl.watchers.empty()) return;
+    // The maker is always the front order, so it is ahead of every other watcher
+    for (size_t i = 0; i < lvl.watchers.size(); ) {
+        WatchState* w = lvl.watchers[i];
+        if (w->id == makerId && w->pos.rank == 0) { // the front order itself, not a duplicate id
+            w->pos.remainingQty -= traded;
+            if (makerDone) {
+                w->pos.resting = false;
+                lvl.watchers.erase(lvl.watchers.begin() + static_cast<std::ptrdiff_t>(i));
+                notifyQueue(*w);
+                watched_.erase(makerId); // filled and unlinked: nothing left to track
+                continue;
+            }
+        } else {
+            w->pos.qtyAhead -= traded;
+            if (makerDone) w->pos.rank -= 1;
+        }
+        notifyQueue(*w);
+        ++i;
+    }
+}
+
+// Unlinks w from the level it is queued at (if resting); w stays in watched_
+template<class Listener>
+void BasicOrderBook<Listener>::detachWatch(WatchState& w) {
+    if (!w.pos.resting) return;
+    auto& book = (w.pos.side == OrderSide::BUY) ? bids_ : asks_;
+    auto b = book.find(w.pos.priceTicks);
+    if (b != book.end()) {
+        auto& ws = b->second.watchers;
+        ws.erase(std::remove(ws.begin(), ws.end(), &w), ws.end());
+    }
+}
+
+// Frees the watch on `orderId` once nothing is resting under it. A watch that
+// is still queued (e.g. another order reused the id) is kept.
+template<class Listener>
+void BasicOrderBook<Listener>::dropWatchIfGone(int orderId) {
+    if (watched_.empty()) return;
+    auto wit = watched_.find(orderId);
+    if (wit != watched_.end() && !wit->second.pos.resting) watched_.erase(wit);
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::notifyQueue(const WatchState& w) {
+    if (queueCallback_) queueCallback_(w.id, w.pos);
+}
+
+template<class Listener>
+template<class Event>
+void BasicOrderBook<Listener>::raise(const Event& e) {
+    if constexpr (kHasListener) {
+        if (listener_) events_.emplace_back(e);
+    } else {
+        (void)e;
+    }
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::notifyLevel(OrderSide side, Price px, const LevelInfo& lvl) {
+    raise(LevelChangedEvent{side, px, lvl.totalQty, static_cast<int>(lvl.orders.size())});
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::notifyDone(int id, DoneReason why, int unfilledQty) {
+    raise(OrderDoneEvent{id, why, unfilledQty});
+}
+
+template<class Listener>
+void BasicOrderBook<Listener>::flushEvents() {
+    if constexpr (kHasListener) {
+        // Hooks cannot raise events here: their calls are queued until we return
+        for (const BufferedEvent& e : events_) {
+            if (!listener_) break; // detached by a hook
+            switch (e.kind) {
+                case BufferedEvent::Accepted: listener_->onOrderAccepted(e.accepted); break;
+                case BufferedEvent::Fill:     listener_->onFill(e.fill); break;
+                case BufferedEvent::Done:     listener_->onOrderDone(e.done); break;
+                case BufferedEvent::Level:    listener_->onLevelChanged(e.level); break;
+                case BufferedEvent::Tob:      listener_->onTobChanged(e.tob); break;
+            }
+        }
+        events_.clear();
+    }
+}
+
+// Templated matcher (handles BUY or SELL)
+template<class Listener>
+template<OrderSide SIDE>
+bool BasicOrderBook<Listener>::match(Order& incoming) {
+    // FOK pre-check
+    if (incoming.tif == TimeInForce::FOK) {
+        std::optional<Price> limit = (incoming.type == OrderType::LIMIT)
+            ? std::optional<Price>(incoming.priceTicks) : std::nullopt;
+        if (!canFullyFill(SIDE, limit, incoming.quantity)) return true;
+    }
+
+    auto &opp = (SIDE == OrderSide::BUY) ? asks_ : bids_;
+    auto crosses = [&](Price topPx) {
+        if (incoming.type == OrderType::MARKET) return true;
+        if constexpr (SIDE == OrderSide::BUY)  return topPx <= incoming.priceTicks;
+        else                                    return topPx >= incoming.priceTicks;
+    };
+
+    while (incoming.quantity > 0 && !opp.empty()) {
+        // Best opposite level
+        auto it = (SIDE == OrderSide::BUY) ? opp.begin() : std::prev(opp.end());
+        Price px = it->first;
+        if (!crosses(px)) break;
+
+        auto& lvl = it->second;
+        while (incoming.quantity > 0 && !lvl.orders.empty()) {
+            auto lit = lvl.orders.begin();
+            Order& maker = *lit;
+            int traded = std::min(incoming.quantity, maker.quantity);
+            if constexpr (SIDE == OrderSide::BUY)
+                logTrade(incoming.timestamp, px, traded, incoming.id, maker.id);
+            else
+                logTrade(incoming.timestamp, px, traded, maker.id, incoming.id);
+
+            incoming.quantity -= traded;
+            maker.quantity    -= traded;
+            lvl.totalQty      -= traded;
+            queueOnFill(lvl, maker.id, traded, maker.quantity == 0);
+            raise(FillEvent{maker.id, incoming.id, SIDE, px, traded, maker.quantity, incoming.quantity});
+            if (maker.quantity == 0) {
+                notifyDone(maker.id, DoneReason::Filled, 0);
+                idIndex_.erase(maker.id);
+                lvl.orders.erase(lit);
+            }
+        }
+        notifyLevel((SIDE == OrderSide::BUY) ? OrderSide::SELL : OrderSide::BUY, px, lvl);
+        if (lvl.orders.empty()) opp.erase(it);
+        updateBestOnChange();
+
+        if (incoming.type == OrderType::MARKET) {
+            if (opp.empty()) break;
+        } else {
+            if (opp.empty()) break;
+            // re-check crossing for LIMIT after potential best changed
+            auto nextTop = (SIDE == OrderSide::BUY) ? opp.begin()->first : std::prev(opp.end())->first;
+            if (!crosses(nextTop)) break;
+        }
+    }
+    return true;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::canFullyFill(OrderSide side, std::optional<Price> limitPx, int qty) const {
+    int need = qty;
+    if (side == OrderSide::BUY) {
+        for (auto it = asks_.begin(); it != asks_.end() && need > 0; ++it) {
+            Price px = it->first;
+            if (limitPx && px > *limitPx) break;
+            need -= it->second.totalQty;
+        }
+    } else {
+        for (auto it = bids_.rbegin(); it != bids_.rend() && need > 0; ++it) {
+            Price px = it->first;
+            if (limitPx && px < *limitPx) break;
+            need -= it->second.totalQty;
+        }
+    }
+    return need <= 0;
+}
+
+// -------- Parsing --------
+
+template<class Listener>
+std::optional<OrderSide> BasicOrderBook<Listener>::parseSide(const std::string& s) {
+    if (s == "BUY") return OrderSide::BUY;
+    if (s == "SELL") return OrderSide::SELL;
+    return std::nullopt;
+}
+template<class Listener>
+std::optional<OrderType> BasicOrderBook<Listener>::parseType(const std::string& s) {
+    if (s == "LIMIT") return OrderType::LIMIT;
+    if (s == "MARKET") return OrderType::MARKET;
+    return std::nullopt;
+}
+template<class Listener>
+std::optional<TimeInForce> BasicOrderBook<Listener>::parseTif(const std::string& s) {
+    if (s == "GTC") return TimeInForce::GTC;
+    if (s == "IOC") return TimeInForce::IOC;
+    if (s == "FOK") return TimeInForce::FOK;
+    if (s == "DAY") return TimeInForce::DAY;
+    return std::nullopt;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::parseHumanLine(const std::string& line, Order& out, bool& isCancel, bool& isModify,
+                               int& modId, Price& modPxTicks, int& modQty) {
+    std::istringstream iss(line);
+    std::string ts;
+    if (!(iss >> ts)) return false;
+    std::string word;
+    if (!(iss >> word)) return false;
+
+    if (word == "CANCEL") {
+        std::string tok;
+        while (iss >> tok) {
+            if (tok.rfind("id=",0)==0) {
+                std::string v = tok.substr(3);
+                int idv=0; if (!v.empty() && orderbook_detail::safe_stoi(v, idv)) { modId = idv; isCancel = true; out.timestamp = ts; return true; }
+                else return false;
+            }
+        }
+        return false;
+    }
+    if (word == "MODIFY") {
+        std::string tok;
+        bool haveId=false, havePx=false, haveQty=false;
+        while (iss >> tok) {
+            if (tok.rfind("id=",0)==0) {
+                std::string v = tok.substr(3); int idv=0; if (!v.empty() && orderbook_detail::safe_stoi(v,idv)) { modId=idv; haveId=true; }
+                else return false;
+            } else if (tok.rfind("price=",0)==0) {
+                std::string v = tok.substr(6); double px=0; if (!v.empty() && orderbook_detail::safe_stod(v,px)) { modPxTicks=toTicks(px); havePx=true; }
+                else return false;
+            } else if (tok.rfind("qty=",0)==0) {
+                std::string v = tok.substr(4); int q=0; if (!v.empty() && orderbook_detail::safe_stoi(v,q) && q>0) { modQty=q; haveQty=true; }
+                else return false;
+            }
+        }
+        if (!(haveId && havePx && haveQty)) return false;
+        isModify = true; out.timestamp = ts; return true;
+    }
+
+    // TYPE SIDE ...
+    auto maybeType = parseType(word);
+    if (!maybeType) return false;
+    std::string sideStr; if (!(iss >> sideStr)) return false;
+    auto maybeSide = parseSide(sideStr);
+    if (!maybeSide) return false;
+
+    out.timestamp = ts;
+    out.type = *maybeType;
+    out.side = *maybeSide;
+    out.tif = TimeInForce::GTC;
+    out.id = 0;
+
+    if (out.type == OrderType::LIMIT) {
+        std::string pxStr, qtyStr;
+        if (!(iss >> pxStr >> qtyStr)) return false;
+        double px=0; int q=0;
+        if (!orderbook_detail::safe_stod(pxStr, px) || !orderbook_detail::safe_stoi(qtyStr, q)) return false;
+        out.priceTicks = toTicks(px); out.quantity = q;
+    } else { // MARKET
+        std::string qtyStr; if (!(iss >> qtyStr)) return false;
+        int q=0; if (!orderbook_detail::safe_stoi(qtyStr, q)) return false;
+        out.quantity = q; out.priceTicks = 0;
+    }
+    // optional tokens
+    std::string tok;
+    while (iss >> tok) {
+        if (tok.rfind("id=",0)==0) {
+            std::string v = tok.substr(3); int idv=0; if (!v.empty() && orderbook_detail::safe_stoi(v,idv)) out.id = idv;
+        } else if (tok.rfind("tif=",0)==0) {
+            auto maybeT = parseTif(tok.substr(4)); if (maybeT) out.tif = *maybeT;
+        }
+    }
+    return true;
+}
+
+template<class Listener>
+bool BasicOrderBook<Listener>::parseCompactCsvLine(const std::string& line, Order& out, bool& isCancel, bool& isModify,
+                                    int& modId, Price& modPxTicks, int& modQty) {
+    // Compact:
+    // A,ts,id,side,price,qty[,tif]
+    // X,ts,id
+    // M,ts,id,price,qty
+    if (line.empty()) return false;
+    char tag = line[0];
+    if (!(tag=='A' || tag=='X' || tag=='M')) return false;
+
+    std::vector<std::string> parts; parts.reserve(8);
+    std::string cur; cur.reserve(line.size());
+    for (char c : line) {
+        if (c==',') { parts.push_back(cur); cur.clear(); }
+        else cur.push_back(c);
+    }
+    parts.push_back(cur);
+
+    if (parts.size() < 3) return false;
+    const std::string& ts = parts[1];
+
+    if (tag=='X') {
+        if (parts.size()<3) return false;
+        int idv=0; if (!orderbook_detail::safe_stoi(parts[2], idv)) return false;
+        modId = idv; isCancel = true; out.timestamp = ts; return true;
+    } else if (tag=='M') {
+        if (parts.size()<5) return false;
+        int idv=0, q=0; double px=0;
+        if (!orderbook_detail::safe_stoi(parts[2], idv)) return false;
+        if (!orderbook_detail::safe_stod(parts[3], px)) return false;
+        if (!orderbook_detail::safe_stoi(parts[4], q) || q<=0) return false;
+        modId=idv; modPxTicks=toTicks(px); modQty=q; isModify=true; out.timestamp = ts; return true;
+    } else { // 'A'
+        if (parts.size()<6) return false;
+        int idv=0, q=0; double px=0;
+        if (!orderbook_detail::safe_stoi(parts[2], idv)) return false;
+        auto maybeSide = parseSide(parts[3]); if (!maybeSide) return false;
+        if (!orderbook_detail::safe_stod(parts[4], px)) return false;
+        if (!orderbook_detail::safe_stoi(parts[5], q)) return false;
+
+        out.id = idv;
+        out.timestamp = ts;
+        out.side = *maybeSide;
+        out.type = OrderType::LIMIT;
+        out.priceTicks = toTicks(px);
+        out.quantity = q;
+        out.tif = TimeInForce::GTC;
+        if (parts.size()>=7) {
+            auto maybeT = parseTif(parts[6]); if (maybeT) out.tif = *maybeT;
+        }
+        return true;
+    }
+}
+
+#endif // ORDERBOOK_IMPL_H
@@ -0,0 +1,62 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer / multi-reader sequence lock over a trivially copyable T.
+// The payload is stored as relaxed atomic words so concurrent readers are
+// race-free by the memory model (no reliance on "benign" races). Safe to place
+// in shared memory: it holds no pointers and its atomics are lock-free.
+template<class T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock payload must be trivially copyable");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "need lock-free 64-bit atomics");
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    // Writer side (one thread only)
+    void store(const T& v) noexcept {
+        uint64_t buf[kWords] = {};
+        std::memcpy(buf, &v, sizeof(T));
+        uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);          // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) words_[i].store(buf[i], std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);
+    }
+
+    // Reader side: one attempt; false if a write overlapped
+    bool tryLoad(T& out) const noexcept {
+        uint64_t s0 = seq_.load(std::memory_order_acquire);
+        if (s0 & 1) return false;
+        uint64_t buf[kWords];
+        for (size_t i = 0; i < kWords; ++i) buf[i] = words_[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != s0) return false;
+        std::memcpy(&out, buf, sizeof(T));
+        return true;
+    }
+
+    // Reader side: spin until a consistent copy is obtained
+    T load() const noexcept {
+        T v;
+        while (!tryLoad(v)) {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+        return v;
+    }
+
+    // Even values count completed writes; changes whenever the payload does
+    uint64_t version() const noexcept { return seq_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint64_t> seq_{0};
+    std::atomic<uint64_t> words_[kWords]{};
+};
+
+#endif // SEQLOCK_H
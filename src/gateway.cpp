@@ -0,0 +1,526 @@
+#include "orderbook.h"
+#include "gateway_protocol.h"
+#include "md_shm.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Order-entry gateway: one epoll loop serving TCP + Unix-domain clients.
+// Each loop iteration drains every readable socket into a batch, runs the
+// whole batch through the engine, then flushes acks/fills back to clients.
+
+namespace {
+
+volatile std::sig_atomic_t gStop = 0;
+void onSignal(int) { gStop = 1; }
+
+struct Args {
+    int         tcpPort = 9000;  // 0 disables TCP
+    std::string unixPath;        // empty disables Unix socket
+    std::string tradesCsv;
+    std::string quotesCsv;
+    std::string mdShm;           // POSIX shm name for market data (empty = off)
+    int64_t     tickScale = 100;
+};
+
+Args parseArgs(int argc, char* argv[]) {
+    Args a;
+    auto usage = [&]() {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--tcp-port N|=N] [--unix PATH|=PATH] [--trades-csv PATH|=PATH] "
+                     "[--quotes-csv PATH|=PATH] [--tick-scale N|=N] [--md-shm NAME|=NAME]\n";
+        std::exit(2);
+    };
+    auto next_is_value = [&](int i) {
+        return (i+1 < argc) && argv[i+1][0] != '-';
+    };
+
+    for (int i=1; i<argc; ++i) {
+        std::string s(argv[i]);
+        std::string key = s, val;
+
+        auto eq = s.find('=');
+        if (eq != std::string::npos) {
+            key = s.substr(0, eq);
+            val = s.substr(eq + 1);
+        } else if (next_is_value(i)) {
+            key = s;
+            val = argv[++i];
+        }
+
+        auto need = [&](const char* k){
+            if (val.empty()) { std::cerr << "Missing value for " << k << "\n"; std::exit(2); }
+        };
+
+        if (key == "--tcp-port") {
+            need("--tcp-port");
+            try { a.tcpPort = std::stoi(val); }
+            catch (...) { std::cerr << "Invalid number for --tcp-port: " << val << "\n"; std::exit(2); }
+        } else if (key == "--unix") {
+            need("--unix"); a.unixPath = val;
+        } else if (key == "--trades-csv") {
+            need("--trades-csv"); a.tradesCsv = val;
+        } else if (key == "--quotes-csv") {
+            need("--quotes-csv"); a.quotesCsv = val;
+        } else if (key == "--md-shm") {
+            need("--md-shm"); a.mdShm = val;
+        } else if (key == "--tick-scale") {
+            need("--tick-scale");
+            try { a.tickScale = static_cast<int64_t>(std::stoll(val)); }
+            catch (...) { std::cerr << "Invalid number for --tick-scale: " << val << "\n"; std::exit(2); }
+        } else if (key == "--help" || key == "-h") {
+            usage();
+        } else {
+            std::cerr << "Unknown option: " << s << "\n";
+            std::exit(2);
+        }
+    }
+    if (a.tcpPort == 0 && a.unixPath.empty()) {
+        std::cerr << "Nothing to listen on (TCP disabled and no --unix path)\n";
+        std::exit(2);
+    }
+    return a;
+}
+
+bool setNonBlocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    return fl >= 0 && fcntl(fd, F_SETFL, fl | O_NONBLOCK) == 0;
+}
+
+// Decoded client request, queued until the end of the read phase
+struct Request {
+    int         fd{-1};
+    gw::MsgType type{gw::MsgType::NewOrder};
+    uint64_t    clOrdId{0};
+    int64_t     priceTicks{0};
+    int32_t     quantity{0};
+    uint8_t     side{0};
+    uint8_t     otype{0};
+    uint8_t     tif{0};
+};
+
+struct Connection {
+    std::string in;            // unparsed inbound bytes
+    std::string out;           // pending outbound bytes
+    size_t      outOff{0};
+    bool        wantWrite{false};
+    bool        dirty{false};  // has output queued this iteration
+    bool        closing{false};
+    std::unordered_map<uint64_t, int> live; // clOrdId -> engine order id
+};
+
+// Where to send fills for a resting engine order
+struct Route {
+    int      fd{-1};
+    uint64_t clOrdId{0};
+};
+
+class Gateway {
+public:
+    explicit Gateway(OrderBook& book) : book_(book) {
+        batch_.reserve(4096);
+        dirty_.reserve(256);
+    }
+    ~Gateway() {
+        for (auto& [fd, c] : conns_) close(fd);
+        for (int fd : listeners_) close(fd);
+        if (ep_ >= 0) close(ep_);
+        if (!unixPath_.empty()) unlink(unixPath_.c_str());
+    }
+
+    bool init() {
+        ep_ = epoll_create1(0);
+        if (ep_ < 0) { std::perror("epoll_create1"); return false; }
+        return true;
+    }
+
+    bool listenTcp(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) { std::perror("socket"); return false; }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::perror("bind(tcp)"); close(fd); return false;
+        }
+        return addListener(fd);
+    }
+
+    bool listenUnix(const std::string& path) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) { std::perror("socket"); return false; }
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Unix socket path too long: " << path << "\n"; close(fd); return false;
+        }
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::perror("bind(unix)"); close(fd); return false;
+        }
+        unixPath_ = path;
+        return addListener(fd);
+    }
+
+    void run() {
+        std::vector<epoll_event> events(256);
+        while (!gStop) {
+            int n = epoll_wait(ep_, events.data(), static_cast<int>(events.size()), 200);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::perror("epoll_wait");
+                break;
+            }
+            if (n == 0) continue;
+
+            // 1) Read phase: drain every ready socket into one batch
+            batch_.clear();
+            for (int i=0; i<n; ++i) {
+                int fd = events[i].data.fd;
+                if (std::find(listeners_.begin(), listeners_.end(), fd) != listeners_.end()) {
+                    acceptAll(fd);
+                    continue;
+                }
+                auto it = conns_.find(fd);
+                if (it == conns_.end()) continue;
+                Connection& c = it->second;
+                if (events[i].events & EPOLLOUT) markDirty(fd, c);
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readConn(fd, c);
+            }
+
+            // 2) Engine phase
+            for (const Request& r : batch_) process(r);
+            book_.clearTrades(); // fills were routed; don't grow unbounded
+            if (!batch_.empty()) {
+                ++batches_;
+                requests_ += batch_.size();
+                maxBatch_ = std::max(maxBatch_, batch_.size());
+            }
+
+            // 3) Write phase
+            for (int fd : dirty_) {
+                auto it = conns_.find(fd);
+                if (it == conns_.end()) continue;
+                it->second.dirty = false;
+                if (!it->second.closing) flush(fd, it->second);
+            }
+            dirty_.clear();
+            for (int fd : closing_) closeConn(fd);
+            closing_.clear();
+        }
+        std::cout << "Gateway stopped: " << accepted_ << " connections, " << requests_ << " requests in "
+                  << batches_ << " batches (avg "
+                  << (batches_ ? static_cast<double>(requests_) / static_cast<double>(batches_) : 0.0)
+                  << ", max " << maxBatch_ << ")\n";
+    }
+
+private:
+    OrderBook& book_;
+    int ep_{-1};
+    std::vector<int> listeners_;
+    std::string unixPath_;
+    std::unordered_map<int, Connection> conns_;
+    std::unordered_map<int, Route> routes_; // engine order id -> owner
+    std::vector<Request> batch_;
+    std::vector<int> dirty_;
+    std::vector<int> closing_;
+    int nextOrderId_{1};
+
+    size_t accepted_{0};
+    size_t requests_{0};
+    size_t batches_{0};
+    size_t maxBatch_{0};
+
+    bool addListener(int fd) {
+        if (listen(fd, 128) < 0 || !setNonBlocking(fd)) {
+            std::perror("listen"); close(fd); return false;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            std::perror("epoll_ctl"); close(fd); return false;
+        }
+        listeners_.push_back(fd);
+        return true;
+    }
+
+    void acceptAll(int lfd) {
+        for (;;) {
+            int fd = accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) std::perror("accept4");
+                return;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // fails harmlessly on AF_UNIX
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            if (epoll_ctl(ep_, EPOLL_CTL_ADD, fd, &ev) < 0) { close(fd); continue; }
+            conns_.emplace(fd, Connection{});
+            ++accepted_;
+        }
+    }
+
+    void readConn(int fd, Connection& c) {
+        char buf[65536];
+        for (;;) {
+            ssize_t r = recv(fd, buf, sizeof(buf), 0);
+            if (r > 0) { c.in.append(buf, static_cast<size_t>(r)); continue; }
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            if (r < 0 && errno == EINTR) continue;
+            markClosing(fd, c); // EOF or hard error
+            break;
+        }
+
+        size_t off = 0;
+        while (c.in.size() - off >= sizeof(gw::MsgHeader)) {
+            auto hdr = gw::readMsg<gw::MsgHeader>(c.in.data() + off);
+            size_t want = gw::msgSize(hdr.type);
+            if (want == 0 || hdr.length != want ||
+                !(hdr.type == gw::MsgType::NewOrder || hdr.type == gw::MsgType::Cancel ||
+                  hdr.type == gw::MsgType::Modify)) {
+                // Framing is lost; nothing sane to resync on
+                markClosing(fd, c);
+                c.in.clear();
+                return;
+            }
+            if (c.in.size() - off < want) break;
+
+            const char* p = c.in.data() + off;
+            Request r;
+            r.fd = fd;
+            r.type = hdr.type;
+            if (hdr.type == gw::MsgType::NewOrder) {
+                auto m = gw::readMsg<gw::NewOrderMsg>(p);
+                r.clOrdId = m.clOrdId; r.priceTicks = m.priceTicks; r.quantity = m.quantity;
+                r.side = m.side; r.otype = m.type; r.tif = m.tif;
+            } else if (hdr.type == gw::MsgType::Cancel) {
+                auto m = gw::readMsg<gw::CancelMsg>(p);
+                r.clOrdId = m.clOrdId;
+            } else {
+                auto m = gw::readMsg<gw::ModifyMsg>(p);
+                r.clOrdId = m.clOrdId; r.priceTicks = m.priceTicks; r.quantity = m.quantity;
+            }
+            batch_.push_back(r);
+            off += want;
+        }
+        c.in.erase(0, off);
+    }
+
+    void process(const Request& r) {
+        auto it = conns_.find(r.fd);
+        if (it == conns_.end()) return;
+        Connection& c = it->second;
+        switch (r.type) {
+            case gw::MsgType::NewOrder: handleNew(r, c); break;
+            case gw::MsgType::Cancel:   handleCancel(r, c); break;
+            case gw::MsgType::Modify:   handleModify(r, c); break;
+            default: break;
+        }
+    }
+
+    void handleNew(const Request& r, Connection& c) {
+        if (r.quantity <= 0) return reject(r, c, gw::RejectReason::BadQuantity);
+        if (r.side > static_cast<uint8_t>(OrderSide::SELL) ||
+            r.otype > static_cast<uint8_t>(OrderType::MARKET) ||
+            r.tif > static_cast<uint8_t>(TimeInForce::DAY)) {
+            return reject(r, c, gw::RejectReason::BadMessage);
+        }
+        if (c.live.count(r.clOrdId)) return reject(r, c, gw::RejectReason::DuplicateId);
+
+        Order o(nextOrderId_++, std::string(),
+                static_cast<OrderSide>(r.side), static_cast<OrderType>(r.otype),
+                static_cast<TimeInForce>(r.tif), r.priceTicks, r.quantity);
+        size_t firstTrade = book_.trades().size();
+        book_.addOrder(o);
+        finishAggressive(r, c, o.id, o.quantity, firstTrade);
+    }
+
+    void handleCancel(const Request& r, Connection& c) {
+        auto lit = c.live.find(r.clOrdId);
+        if (lit == c.live.end()) return reject(r, c, gw::RejectReason::UnknownOrder);
+        int id = lit->second;
+        if (!book_.cancelOrder(id)) return reject(r, c, gw::RejectReason::UnknownOrder);
+        c.live.erase(lit);
+        routes_.erase(id);
+        ack(r, c, id, 0);
+    }
+
+    void handleModify(const Request& r, Connection& c) {
+        auto lit = c.live.find(r.clOrdId);
+        if (lit == c.live.end()) return reject(r, c, gw::RejectReason::UnknownOrder);
+        int id = lit->second;
+        size_t firstTrade = book_.trades().size();
+        if (!book_.modifyOrder(id, r.priceTicks, r.quantity)) {
+            return reject(r, c, gw::RejectReason::UnknownOrder);
+        }
+        finishAggressive(r, c, id, std::max(r.quantity, 0), firstTrade);
+    }
+
+    // Route fills produced by an incoming/modified order, then ack it
+    void finishAggressive(const Request& r, Connection& c, int takerId, int takerQty, size_t firstTrade) {
+        const auto& trades = book_.trades();
+        int remaining = takerQty;
+        for (size_t i = firstTrade; i < trades.size(); ++i) {
+            const Trade& t = trades[i];
+            int makerId = (t.buyId == takerId) ? t.sellId : t.buyId;
+
+            remaining -= t.quantity;
+            auto tf = gw::makeMsg<gw::FillMsg>(gw::MsgType::Fill);
+            tf.clOrdId = r.clOrdId; tf.priceTicks = t.priceTicks; tf.quantity = t.quantity;
+            tf.leavesQty = remaining; tf.liquidity = gw::Liquidity::Taker;
+            send(r.fd, c, tf);
+
+            auto rt = routes_.find(makerId);
+            if (rt == routes_.end()) continue;
+            Route route = rt->second;
+            int leaves = book_.restingQty(makerId);
+            auto mc = conns_.find(route.fd);
+            if (mc != conns_.end()) {
+                auto mf = gw::makeMsg<gw::FillMsg>(gw::MsgType::Fill);
+                mf.clOrdId = route.clOrdId; mf.priceTicks = t.priceTicks; mf.quantity = t.quantity;
+                mf.leavesQty = leaves; mf.liquidity = gw::Liquidity::Maker;
+                send(route.fd, mc->second, mf);
+                if (leaves == 0) mc->second.live.erase(route.clOrdId);
+            }
+            if (leaves == 0) routes_.erase(rt);
+        }
+
+        int leaves = book_.restingQty(takerId);
+        if (leaves > 0) {
+            c.live[r.clOrdId] = takerId;
+            routes_[takerId] = Route{r.fd, r.clOrdId};
+        } else {
+            c.live.erase(r.clOrdId);
+            routes_.erase(takerId);
+        }
+        ack(r, c, takerId, leaves);
+    }
+
+    void ack(const Request& r, Connection& c, int orderId, int leaves) {
+        auto a = gw::makeMsg<gw::AckMsg>(gw::MsgType::Ack);
+        a.clOrdId = r.clOrdId; a.orderId = orderId; a.leavesQty = leaves; a.request = r.type;
+        send(r.fd, c, a);
+    }
+
+    void reject(const Request& r, Connection& c, gw::RejectReason why) {
+        auto m = gw::makeMsg<gw::RejectMsg>(gw::MsgType::Reject);
+        m.clOrdId = r.clOrdId; m.request = r.type; m.reason = why;
+        send(r.fd, c, m);
+    }
+
+    template<class Msg>
+    void send(int fd, Connection& c, const Msg& m) {
+        gw::appendMsg(c.out, m);
+        markDirty(fd, c);
+    }
+
+    void markDirty(int fd, Connection& c) {
+        if (c.dirty) return;
+        c.dirty = true;
+        dirty_.push_back(fd);
+    }
+
+    void markClosing(int fd, Connection& c) {
+        if (c.closing) return;
+        c.closing = true;
+        closing_.push_back(fd);
+    }
+
+    void flush(int fd, Connection& c) {
+        while (c.outOff < c.out.size()) {
+            ssize_t w = ::send(fd, c.out.data() + c.outOff, c.out.size() - c.outOff, MSG_NOSIGNAL);
+            if (w > 0) { c.outOff += static_cast<size_t>(w); continue; }
+            if (w < 0 && errno == EINTR) continue;
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            markClosing(fd, c);
+            return;
+        }
+        bool pending = c.outOff < c.out.size();
+        if (!pending) { c.out.clear(); c.outOff = 0; }
+        if (pending != c.wantWrite) {
+            epoll_event ev{};
+            ev.events = EPOLLIN | (pending ? EPOLLOUT : 0u);
+            ev.data.fd = fd;
+            epoll_ctl(ep_, EPOLL_CTL_MOD, fd, &ev);
+            c.wantWrite = pending;
+        }
+    }
+
+    // Cancel-on-disconnect: a vanished client must not leave orders behind
+    void closeConn(int fd) {
+        auto it = conns_.find(fd);
+        if (it == conns_.end()) return;
+        for (auto& [clOrdId, id] : it->second.live) {
+            book_.cancelOrder(id);
+            routes_.erase(id);
+        }
+        epoll_ctl(ep_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns_.erase(it);
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto args = parseArgs(argc, argv);
+
+    struct sigaction sa{};
+    sa.sa_handler = onSignal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    OrderBook book(args.tickScale);
+    if (!args.tradesCsv.empty()) book.setTradesCsvPath(args.tradesCsv);
+    if (!args.quotesCsv.empty()) book.setQuotesCsvPath(args.quotesCsv);
+
+    MdPublisher md;
+    if (!args.mdShm.empty()) {
+        if (!md.open(args.mdShm, args.tickScale)) {
+            std::cerr << "Failed to create market-data segment: " << args.mdShm << "\n";
+            return 1;
+        }
+        book.setMarketDataPublisher(&md);
+    }
+
+    Gateway gwy(book);
+    if (!gwy.init()) return 1;
+    if (args.tcpPort > 0 && !gwy.listenTcp(args.tcpPort)) return 1;
+    if (!args.unixPath.empty() && !gwy.listenUnix(args.unixPath)) return 1;
+
+    std::cout << "Gateway listening";
+    if (args.tcpPort > 0) std::cout << " tcp://127.0.0.1:" << args.tcpPort;
+    if (!args.unixPath.empty()) std::cout << " unix:" << args.unixPath;
+    std::cout << std::endl;
+
+    gwy.run();
+
+    double bid, ask; int bq, aq;
+    if (book.bestBidAsk(bid,bq,ask,aq)) {
+        std::cout << "Final BestBid " << bid << " ("<< bq << "), BestAsk " << ask << " ("<< aq << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include "order.h"
+#include "gateway_protocol.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Multi-connection load generator for orderbook_gateway.
+// Keeps a fixed window of requests in flight per connection and records the
+// round-trip time from send to the matching Ack/Reject.
+
+namespace {
+
+struct Args {
+    std::string host = "127.0.0.1";
+    int         tcpPort = 9000;
+    std::string unixPath;        // if set, connect over Unix socket instead of TCP
+    int         connections = 4;
+    int         requests = 100000; // per connection
+    int         inflight = 16;     // per connection
+    uint32_t    seed = 42;
+    int64_t     midTicks = 10000;
+    std::string latencyCsv;
+};
+
+Args parseArgs(int argc, char* argv[]) {
+    Args a;
+    auto next_is_value = [&](int i) {
+        return (i+1 < argc) && argv[i+1][0] != '-';
+    };
+    for (int i=1; i<argc; ++i) {
+        std::string s(argv[i]);
+        std::string key = s, val;
+
+        auto eq = s.find('=');
+        if (eq != std::string::npos) {
+            key = s.substr(0, eq);
+            val = s.substr(eq + 1);
+        } else if (next_is_value(i)) {
+            key = s;
+            val = argv[++i];
+        }
+
+        auto need = [&](const char* k){
+            if (val.empty()) { std::cerr << "Missing value for " << k << "\n"; std::exit(2); }
+        };
+        auto num = [&](const char* k) -> long long {
+            need(k);
+            try { return std::stoll(val); }
+            catch (...) { std::cerr << "Invalid number for " << k << ": " << val << "\n"; std::exit(2); }
+        };
+
+        if (key == "--host")              { need("--host"); a.host = val; }
+        else if (key == "--tcp-port")     a.tcpPort = static_cast<int>(num("--tcp-port"));
+        else if (key == "--unix")         { need("--unix"); a.unixPath = val; }
+        else if (key == "--connections")  a.connections = static_cast<int>(num("--connections"));
+        else if (key == "--requests")     a.requests = static_cast<int>(num("--requests"));
+        else if (key == "--inflight")     a.inflight = static_cast<int>(num("--inflight"));
+        else if (key == "--seed")         a.seed = static_cast<uint32_t>(num("--seed"));
+        else if (key == "--mid-ticks")    a.midTicks = num("--mid-ticks");
+        else if (key == "--latency-csv")  { need("--latency-csv"); a.latencyCsv = val; }
+        else {
+            std::cerr << "Unknown option: " << s << "\n"
+                      << "Usage: " << argv[0]
+                      << " [--tcp-port N | --unix PATH] [--host IP] [--connections N] [--requests N]"
+                         " [--inflight N] [--seed N] [--mid-ticks N] [--latency-csv PATH]\n";
+            std::exit(2);
+        }
+    }
+    if (a.connections <= 0 || a.requests <= 0 || a.inflight <= 0) {
+        std::cerr << "--connections, --requests and --inflight must be positive\n";
+        std::exit(2);
+    }
+    return a;
+}
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int connectTo(const Args& a) {
+    if (!a.unixPath.empty()) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, a.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { close(fd); return -1; }
+        return fd;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(a.tcpPort));
+    if (inet_pton(AF_INET, a.host.c_str(), &addr.sin_addr) != 1) { close(fd); return -1; }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) { close(fd); return -1; }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+struct Client {
+    int                  fd{-1};
+    int                  sent{0};
+    int                  done{0};
+    int                  inflight{0};
+    uint64_t             nextClOrdId{1};
+    std::vector<int64_t> sendNs;   // indexed by request number
+    std::vector<int>     reqOf;    // clOrdId -> latest request number
+    std::vector<uint64_t> resting; // clOrdIds acked with leaves > 0
+    std::string          in;
+    std::string          out;
+};
+
+bool writeAll(int fd, const std::string& buf) {
+    size_t off = 0;
+    while (off < buf.size()) {
+        ssize_t w = send(fd, buf.data() + off, buf.size() - off, MSG_NOSIGNAL);
+        if (w > 0) { off += static_cast<size_t>(w); continue; }
+        if (w < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto args = parseArgs(argc, argv);
+
+    std::mt19937_64 rng(args.seed);
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    std::uniform_int_distribution<int> offset(-5, 5);
+    std::uniform_int_distribution<int> qty(1, 200);
+
+    int ep = epoll_create1(0);
+    if (ep < 0) { std::perror("epoll_create1"); return 1; }
+
+    std::vector<Client> clients(static_cast<size_t>(args.connections));
+    for (size_t i = 0; i < clients.size(); ++i) {
+        Client& c = clients[i];
+        c.fd = connectTo(args);
+        if (c.fd < 0) { std::perror("connect"); return 1; }
+        c.sendNs.assign(static_cast<size_t>(args.requests), 0);
+        c.reqOf.assign(static_cast<size_t>(args.requests) + 1, -1);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, c.fd, &ev);
+    }
+
+    // Queue one request: mostly passive limits, some cancels, a few IOC takers
+    auto enqueue = [&](Client& c) {
+        int reqNo = c.sent++;
+        double r = u01(rng);
+        uint64_t clOrdId;
+        if (r < 0.20 && !c.resting.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, c.resting.size() - 1);
+            size_t k = pick(rng);
+            clOrdId = c.resting[k];
+            c.resting[k] = c.resting.back();
+            c.resting.pop_back();
+            auto m = gw::makeMsg<gw::CancelMsg>(gw::MsgType::Cancel);
+            m.clOrdId = clOrdId;
+            gw::appendMsg(c.out, m);
+        } else {
+            clOrdId = c.nextClOrdId++;
+            bool buy = u01(rng) < 0.5;
+            bool ioc = r > 0.95;
+            int d = offset(rng);
+            auto m = gw::makeMsg<gw::NewOrderMsg>(gw::MsgType::NewOrder);
+            m.clOrdId = clOrdId;
+            m.priceTicks = args.midTicks + (buy ? -d : d) + (ioc ? (buy ? 5 : -5) : 0);
+            m.quantity = qty(rng);
+            m.side = static_cast<uint8_t>(buy ? OrderSide::BUY : OrderSide::SELL);
+            m.type = static_cast<uint8_t>(OrderType::LIMIT);
+            m.tif = static_cast<uint8_t>(ioc ? TimeInForce::IOC : TimeInForce::GTC);
+            gw::appendMsg(c.out, m);
+        }
+        c.reqOf[clOrdId] = reqNo;
+        c.sendNs[static_cast<size_t>(reqNo)] = nowNs();
+        ++c.inflight;
+    };
+
+    auto topUp = [&](Client& c) {
+        while (c.inflight < args.inflight && c.sent < args.requests) enqueue(c);
+        if (!c.out.empty()) {
+            if (!writeAll(c.fd, c.out)) { std::perror("send"); std::exit(1); }
+            c.out.clear();
+        }
+    };
+
+    std::vector<int64_t> latencies;
+    latencies.reserve(static_cast<size_t>(args.connections) * static_cast<size_t>(args.requests));
+    size_t fills = 0, rejects = 0;
+
+    int64_t t0 = nowNs();
+    for (auto& c : clients) topUp(c);
+
+    size_t finished = 0;
+    std::vector<epoll_event> events(clients.size());
+    char buf[65536];
+    while (finished < clients.size()) {
+        int n = epoll_wait(ep, events.data(), static_cast<int>(events.size()), 5000);
+        if (n < 0) { if (errno == EINTR) continue; std::perror("epoll_wait"); return 1; }
+        if (n == 0) { std::cerr << "Timed out waiting for gateway responses\n"; return 1; }
+        for (int i = 0; i < n; ++i) {
+            Client& c = clients[events[i].data.u64];
+            ssize_t r = recv(c.fd, buf, sizeof(buf), 0);
+            if (r <= 0) { std::cerr << "Gateway closed the connection\n"; return 1; }
+            c.in.append(buf, static_cast<size_t>(r));
+            int64_t now = nowNs();
+
+            size_t off = 0;
+            while (c.in.size() - off >= sizeof(gw::MsgHeader)) {
+                auto hdr = gw::readMsg<gw::MsgHeader>(c.in.data() + off);
+                if (hdr.length == 0) { std::cerr << "Malformed frame\n"; return 1; }
+                if (c.in.size() - off < hdr.length) break;
+                const char* p = c.in.data() + off;
+                uint64_t clOrdId = 0;
+                bool final = false;
+                if (hdr.type == gw::MsgType::Ack) {
+                    auto m = gw::readMsg<gw::AckMsg>(p);
+                    clOrdId = m.clOrdId; final = true;
+                    if (m.request != gw::MsgType::Cancel && m.leavesQty > 0) c.resting.push_back(clOrdId);
+                } else if (hdr.type == gw::MsgType::Reject) {
+                    auto m = gw::readMsg<gw::RejectMsg>(p);
+                    clOrdId = m.clOrdId; final = true; ++rejects;
+                } else if (hdr.type == gw::MsgType::Fill) {
+                    auto m = gw::readMsg<gw::FillMsg>(p);
+                    ++fills;
+                    if (m.liquidity == gw::Liquidity::Maker && m.leavesQty == 0) {
+                        uint64_t id = m.clOrdId; // packed field; don't bind a reference to it
+                        auto it = std::find(c.resting.begin(), c.resting.end(), id);
+                        if (it != c.resting.end()) { *it = c.resting.back(); c.resting.pop_back(); }
+                    }
+                }
+                if (final && clOrdId < c.reqOf.size() && c.reqOf[clOrdId] >= 0) {
+                    latencies.push_back(now - c.sendNs[static_cast<size_t>(c.reqOf[clOrdId])]);
+                    --c.inflight;
+                    ++c.done;
+                }
+                off += hdr.length;
+            }
+            c.in.erase(0, off);
+
+            bool wasDone = c.done >= args.requests;
+            topUp(c);
+            if (wasDone && c.inflight == 0) {
+                epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+                ++finished;
+            }
+        }
+    }
+    int64_t t1 = nowNs();
+
+    for (auto& c : clients) close(c.fd);
+    close(ep);
+
+    if (latencies.empty()) { std::cout << "No responses recorded.\n"; return 0; }
+    std::vector<int64_t> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    auto pct = [&](double q) {
+        size_t idx = static_cast<size_t>(q / 100.0 * static_cast<double>(sorted.size() - 1));
+        return static_cast<double>(sorted[idx]) / 1e3;
+    };
+    double secs = static_cast<double>(t1 - t0) / 1e9;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Requests: " << latencies.size() << " over " << args.connections << " connections ("
+              << fills << " fills, " << rejects << " rejects)\n"
+              << "Throughput: " << static_cast<double>(latencies.size()) / secs << " req/s\n"
+              << "RTT (us) P50 " << pct(50) << " / P90 " << pct(90) << " / P99 " << pct(99)
+              << " / P99.9 " << pct(99.9) << " / max " << static_cast<double>(sorted.back()) / 1e3 << "\n";
+
+    if (!args.latencyCsv.empty()) {
+        std::ofstream out(args.latencyCsv);
+        out << "ns\n";
+        for (auto ns : latencies) out << ns << "\n";
+    }
+    return 0;
+}
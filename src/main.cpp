@@ -1,4 +1,5 @@
 #include "orderbook.h"
+#include "md_shm.h"
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -11,6 +12,7 @@ struct Args {
     std::string quotesCsv = "data/quotes.csv";
     std::string latencyCsv= "data/latency.csv";
     std::string snapshotDir = "data/snapshots";
+    std::string mdShm;       // POSIX shm name for market data (empty = off)
     size_t snapshotEvery = 0;
     int64_t tickScale = 100; // ticks per $1.00 (default: cents)
 };
@@ -21,7 +23,7 @@ static Args parseArgs(int argc, char* argv[]) {
         std::cerr << "Usage: " << argv[0]
                   << " <input_file> [--snapshot-every N|=N] [--snap-dir DIR|=DIR] "
                      "[--trades-csv PATH|=PATH] [--quotes-csv PATH|=PATH] [--latency-csv PATH|=PATH] "
-                     "[--tick-scale N|=N]\n";
+                     "[--tick-scale N|=N] [--md-shm NAME|=NAME]\n";
         std::exit(1);
     }
     a.inputFile = argv[1];
@@ -63,6 +65,8 @@ static Args parseArgs(int argc, char* argv[]) {
             need("--tick-scale");
             try { a.tickScale = static_cast<int64_t>(std::stoll(val)); }
             catch (...) { std::cerr << "Invalid number for --tick-scale: " << val << "\n"; std::exit(2); }
+        } else if (key == "--md-shm") {
+            need("--md-shm"); a.mdShm = val;
         } else {
             std::cerr << "Unknown option: " << s << "\n";
             std::exit(2);
@@ -85,6 +89,15 @@ int main(int argc, char* argv[]) {
     if (!args.quotesCsv.empty()) book.setQuotesCsvPath(args.quotesCsv);
     if (args.snapshotEvery > 0)  book.setSnapshotCadence(args.snapshotEvery, args.snapshotDir);
 
+    MdPublisher md;
+    if (!args.mdShm.empty()) {
+        if (!md.open(args.mdShm, args.tickScale)) {
+            std::cerr << "Failed to create market-data segment: " << args.mdShm << "\n";
+            return 1;
+        }
+        book.setMarketDataPublisher(&md);
+    }
+
     std::vector<long long> latencies;
     latencies.reserve(200000);
 
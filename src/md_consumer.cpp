@@ -0,0 +1,120 @@
+#include "md_shm.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Example market-data consumer: attaches to the engine's shared-memory segment,
+// prints the top of book whenever it changes and every trade as it arrives.
+
+namespace {
+volatile std::sig_atomic_t gStop = 0;
+void onSignal(int) { gStop = 1; }
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = "/orderbook_md";
+    int levels = 1;
+    long idleUs = 100;   // sleep when nothing changed (0 = busy-spin)
+    bool quiet = false;  // count updates only
+
+    auto next_is_value = [&](int i) {
+        return (i+1 < argc) && argv[i+1][0] != '-';
+    };
+
+    for (int i=1; i<argc; ++i) {
+        std::string s(argv[i]);
+        if (s == "--quiet") { quiet = true; continue; } // flag: takes no value
+        std::string key = s, val;
+
+        auto eq = s.find('=');
+        if (eq != std::string::npos) {
+            key = s.substr(0, eq);
+            val = s.substr(eq + 1);
+        } else if (next_is_value(i)) {
+            key = s;
+            val = argv[++i];
+        }
+
+        auto need = [&](const char* k){
+            if (val.empty()) { std::cerr << "Missing value for " << k << "\n"; std::exit(2); }
+        };
+        auto num = [&](const char* k) -> long {
+            need(k);
+            try { return std::stol(val); }
+            catch (...) { std::cerr << "Invalid number for " << k << ": " << val << "\n"; std::exit(2); }
+        };
+
+        if (key == "--shm")            { need("--shm"); name = val; }
+        else if (key == "--levels")    levels = static_cast<int>(num("--levels"));
+        else if (key == "--idle-us")   idleUs = num("--idle-us");
+        else {
+            std::cerr << "Unknown option: " << s << "\n"
+                      << "Usage: " << argv[0] << " [--shm NAME] [--levels N] [--idle-us N] [--quiet]\n";
+            return 2;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    MdReader md;
+    while (!md.open(name)) {
+        if (gStop) return 1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100)); // wait for the publisher
+    }
+    std::cerr << "Attached to " << name << " (depth " << md.depth() << ", tick scale " << md.tickScale() << ")\n";
+    levels = std::min(levels, md.depth());
+
+    const double scale = static_cast<double>(md.tickScale());
+    uint64_t lastVersion = 0, books = 0, trades = 0, lost = 0;
+    MdTrade buf[256];
+    std::cout << std::fixed << std::setprecision(2);
+
+    while (!gStop) {
+        bool idle = true;
+
+        uint64_t v = md.bookVersion();
+        BookSnapshot s;
+        if (v != lastVersion && !(v & 1) && md.readBook(s)) {
+            lastVersion = v;
+            ++books;
+            idle = false;
+            if (!quiet) {
+                std::cout << "BOOK #" << s.eventSeq;
+                for (int k = 0; k < levels; ++k) {
+                    std::cout << " | ";
+                    if (k < s.bidLevels) std::cout << s.bids[k].qty << " @ " << s.bids[k].priceTicks / scale;
+                    else                 std::cout << "-";
+                    std::cout << " x ";
+                    if (k < s.askLevels) std::cout << s.asks[k].priceTicks / scale << " @ " << s.asks[k].qty;
+                    else                 std::cout << "-";
+                }
+                std::cout << "\n";
+            }
+        }
+
+        size_t n;
+        while ((n = md.pollTrades(buf, sizeof(buf) / sizeof(buf[0]), lost)) > 0) {
+            trades += n;
+            idle = false;
+            if (quiet) continue;
+            for (size_t k = 0; k < n; ++k) {
+                std::cout << "TRADE #" << buf[k].seq << " " << buf[k].qty << " @ " << buf[k].priceTicks / scale
+                          << " (BUY #" << buf[k].buyId << " - SELL #" << buf[k].sellId << ")\n";
+            }
+        }
+
+        if (idle) {
+            if (!md.publisherLive()) break;
+            if (idleUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(idleUs));
+        }
+    }
+
+    std::cerr << "Book updates seen: " << books << ", trades: " << trades << ", trades lost: " << lost << "\n";
+    return 0;
+}
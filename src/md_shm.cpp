@@ -0,0 +1,119 @@
+#include "md_shm.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+// -------- Publisher --------
+
+MdPublisher::~MdPublisher() { close(); }
+
+bool MdPublisher::open(const std::string& name, int64_t tickScale, int depth) {
+    close();
+    shm_unlink(name.c_str()); // stale segment from a previous run
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) { std::perror("shm_open"); return false; }
+    if (ftruncate(fd, static_cast<off_t>(sizeof(MdShmLayout))) != 0) {
+        std::perror("ftruncate"); ::close(fd); shm_unlink(name.c_str()); return false;
+    }
+    void* p = mmap(nullptr, sizeof(MdShmLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) { std::perror("mmap"); shm_unlink(name.c_str()); return false; }
+
+    depth_ = std::clamp(depth, 0, kSnapshotDepth);
+    shm_ = new (p) MdShmLayout{};
+    shm_->version   = kMdVersion;
+    shm_->depth     = static_cast<uint32_t>(depth_);
+    shm_->tickScale = tickScale;
+    shm_->tradeRing = kMdTradeRing;
+    shm_->live.store(1, std::memory_order_relaxed);
+    // Readers check magic first, so publish it once everything else is in place
+    shm_->magic.store(kMdMagic, std::memory_order_release);
+    name_ = name;
+    return true;
+}
+
+void MdPublisher::close() {
+    if (!shm_) return;
+    shm_->live.store(0, std::memory_order_release);
+    munmap(shm_, sizeof(MdShmLayout));
+    shm_unlink(name_.c_str()); // attached readers keep their mapping
+    shm_ = nullptr;
+    name_.clear();
+}
+
+// -------- Reader --------
+
+namespace {
+// Seqlock::load() would spin forever on a slot its writer never finished
+template<class T>
+bool loadBounded(const Seqlock<T>& slot, const MdShmLayout& shm, T& out) {
+    for (int i = 0; i < kMdReadSpins; ++i) {
+        if (slot.tryLoad(out)) return true;
+        if (shm.live.load(std::memory_order_acquire) == 0) return slot.tryLoad(out);
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+    return false;
+}
+} // namespace
+
+MdReader::~MdReader() { close(); }
+
+bool MdReader::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(MdShmLayout)) {
+        ::close(fd); return false;
+    }
+    void* p = mmap(nullptr, sizeof(MdShmLayout), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+
+    auto* layout = static_cast<const MdShmLayout*>(p);
+    if (layout->magic.load(std::memory_order_acquire) != kMdMagic ||
+        layout->version != kMdVersion || layout->tradeRing != kMdTradeRing) {
+        munmap(p, sizeof(MdShmLayout));
+        return false;
+    }
+    shm_ = layout;
+    nextTrade_ = 0;
+    return true;
+}
+
+void MdReader::close() {
+    if (!shm_) return;
+    munmap(const_cast<MdShmLayout*>(shm_), sizeof(MdShmLayout));
+    shm_ = nullptr;
+}
+
+bool MdReader::readBook(BookSnapshot& out) const { return loadBounded(shm_->book, *shm_, out); }
+
+size_t MdReader::pollTrades(MdTrade* out, size_t maxOut, uint64_t& lost) {
+    size_t n = 0;
+    uint64_t head = shm_->tradeCount.load(std::memory_order_acquire);
+    while (n < maxOut && nextTrade_ < head) {
+        if (head - nextTrade_ > kMdTradeRing) {
+            // Lapped: everything older than one ring is gone
+            lost += head - kMdTradeRing - nextTrade_;
+            nextTrade_ = head - kMdTradeRing;
+        }
+        MdTrade t;
+        if (!loadBounded(shm_->trades[nextTrade_ & (kMdTradeRing - 1)], *shm_, t)) break;
+        if (t.seq != nextTrade_) {
+            // Overwritten while we were reading; re-sync against the new head
+            head = shm_->tradeCount.load(std::memory_order_acquire);
+            if (head - nextTrade_ <= kMdTradeRing) { lost += 1; ++nextTrade_; }
+            continue;
+        }
+        out[n++] = t;
+        ++nextTrade_;
+    }
+    return n;
+}
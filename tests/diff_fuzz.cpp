@@ -0,0 +1,301 @@
+#include "orderbook.h"
+#include "reference_matcher.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Differential fuzzer: replays seeded add/cancel/modify/market/IOC/FOK streams
+// through OrderBook and ReferenceMatcher and compares return values, trades,
+// book state and watched-order queue positions after every event. Failing
+// streams are shrunk to a minimal reproducer printed in the simulator's
+// human-readable input format.
+//
+//   diff_fuzz [--seed N] [--cases N] [--events N]    quick run (ctest)
+//   diff_fuzz --soak [--seconds N] [--events N]       run at scale until time is up
+//   diff_fuzz --self-test                             harness must catch a planted bug
+
+namespace {
+
+std::string fmtPx(Price ticks) {
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2) << static_cast<double>(ticks) / 100.0;
+    return os.str();
+}
+
+// Simulator input line (tick scale 100)
+std::string toLine(const Event& e, size_t i) {
+    std::ostringstream os;
+    os << "09:30:" << std::setw(2) << std::setfill('0') << (i % 60) << " ";
+    // MODIFY to qty <= 0 is a cancel in the engine; the simulator's parser
+    // rejects qty=0, so write it as the CANCEL it is
+    if (e.kind == Event::Cancel || (e.kind == Event::Modify && e.qty <= 0)) {
+        os << "CANCEL id=" << e.targetId;
+    } else if (e.kind == Event::Modify) {
+        os << "MODIFY id=" << e.targetId << " price=" << fmtPx(e.pxTicks) << " qty=" << e.qty;
+    } else {
+        const Order& o = e.order;
+        const char* side = o.side == OrderSide::BUY ? "BUY" : "SELL";
+        const char* tif  = o.tif == TimeInForce::IOC ? "IOC" : o.tif == TimeInForce::FOK ? "FOK"
+                         : o.tif == TimeInForce::DAY ? "DAY" : "GTC";
+        if (o.type == OrderType::MARKET) os << "MARKET " << side << " " << o.quantity;
+        else                             os << "LIMIT " << side << " " << fmtPx(o.priceTicks) << " " << o.quantity;
+        os << " id=" << o.id << " tif=" << tif;
+    }
+    return os.str();
+}
+
+// Watch a third of the ids before they arrive and a third once they rest,
+// so both the incremental and the seeding paths are exercised
+inline bool watchBefore(int id) { return id % 3 == 0; }
+inline bool watchAfter(int id)  { return id % 3 == 1; }
+
+// Compares full engine state against the reference; empty string if equal
+std::string compareBooks(const OrderBook& book, const ReferenceMatcher& ref) {
+    std::ostringstream err;
+    const auto& orders = ref.orders();
+    if (book.orderCount() != orders.size()) {
+        err << "resting order count " << book.orderCount() << " != reference " << orders.size();
+        return err.str();
+    }
+    auto ahead = ref.queueAhead();
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const auto& r = orders[i];
+        int q = book.restingQty(r.id);
+        if (q != r.qty) {
+            err << "order " << r.id << " resting qty " << q << " != reference " << r.qty;
+            return err.str();
+        }
+        QueuePosition pos;
+        if (book.queuePosition(r.id, pos)) {
+            if (!pos.resting || pos.side != r.side || pos.priceTicks != r.px ||
+                pos.qtyAhead != ahead[i].first || pos.rank != ahead[i].second || pos.remainingQty != r.qty) {
+                err << "order " << r.id << " queue position (resting=" << pos.resting << " px=" << pos.priceTicks
+                    << " ahead=" << pos.qtyAhead << " rank=" << pos.rank << " qty=" << pos.remainingQty
+                    << ") != reference (px=" << r.px << " ahead=" << ahead[i].first << " rank="
+                    << ahead[i].second << " qty=" << r.qty << ")";
+                return err.str();
+            }
+        }
+    }
+
+    BookSnapshot s;
+    book.fillSnapshot(s);
+    auto cmpSide = [&](const char* name, const std::vector<std::pair<Price, ReferenceMatcher::Level>>& lv,
+                       const BookLevel* got, int gotLevels) {
+        int want = static_cast<int>(std::min<size_t>(lv.size(), kSnapshotDepth));
+        if (gotLevels != want) {
+            err << name << " levels " << gotLevels << " != reference " << want;
+            return false;
+        }
+        for (int k = 0; k < want; ++k) {
+            if (got[k].priceTicks != lv[k].first || got[k].qty != lv[k].second.qty ||
+                got[k].orders != lv[k].second.orders) {
+                err << name << " level " << k << " " << got[k].qty << "@" << got[k].priceTicks << " ("
+                    << got[k].orders << " orders) != reference " << lv[k].second.qty << "@" << lv[k].first
+                    << " (" << lv[k].second.orders << " orders)";
+                return false;
+            }
+        }
+        return true;
+    };
+    auto bids = ref.levels(OrderSide::BUY);
+    auto asks = ref.levels(OrderSide::SELL);
+    if (!cmpSide("bid", bids, s.bids, s.bidLevels)) return err.str();
+    if (!cmpSide("ask", asks, s.asks, s.askLevels)) return err.str();
+    if (!bids.empty() && (s.bestBidPx != bids[0].first || s.bestBidQty != bids[0].second.qty))
+        return "cached best bid is stale";
+    if (!asks.empty() && (s.bestAskPx != asks[0].first || s.bestAskQty != asks[0].second.qty))
+        return "cached best ask is stale";
+    return {};
+}
+
+struct Failure {
+    size_t      eventIndex{0};
+    std::string what;
+};
+
+// Replays `events` through both engines; returns true and fills `f` on the first mismatch
+bool findMismatch(const std::vector<Event>& events, bool plantBug, Failure& f) {
+    OrderBook book;
+    ReferenceMatcher ref;
+    ref.bugTakerPrice = plantBug;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        size_t engineTrades = book.trades().size();
+        size_t refTrades = ref.fills().size();
+        std::ostringstream err;
+
+        if (e.kind == Event::Add) {
+            if (watchBefore(e.order.id)) book.watchOrder(e.order.id);
+            apply(book, e);
+            ref.add(e.order);
+            if (watchAfter(e.order.id)) book.watchOrder(e.order.id);
+        } else {
+            bool a = apply(book, e);
+            bool b = e.kind == Event::Cancel ? ref.cancel(e.targetId)
+                                             : ref.modify(e.targetId, e.pxTicks, e.qty);
+            if (a != b) err << "returned " << a << ", reference returned " << b;
+        }
+
+        // Trades produced by this event, in order
+        const auto& got = book.trades();
+        const auto& want = ref.fills();
+        if (err.str().empty() && got.size() - engineTrades != want.size() - refTrades) {
+            err << (got.size() - engineTrades) << " trades, reference " << (want.size() - refTrades);
+        }
+        for (size_t k = 0; err.str().empty() && k < want.size() - refTrades; ++k) {
+            const Trade& t = got[engineTrades + k];
+            const auto& w = want[refTrades + k];
+            if (t.priceTicks != w.px || t.quantity != w.qty || t.buyId != w.buyId || t.sellId != w.sellId) {
+                err << "trade " << k << ": " << t.quantity << "@" << t.priceTicks << " buy#" << t.buyId
+                    << " sell#" << t.sellId << " != reference " << w.qty << "@" << w.px << " buy#" << w.buyId
+                    << " sell#" << w.sellId;
+            }
+        }
+
+        // Orders this event touched that the reference says are gone must not look resting
+        if (err.str().empty()) {
+            std::vector<int> touched{e.kind == Event::Add ? e.order.id : e.targetId};
+            for (size_t k = refTrades; k < want.size(); ++k) { touched.push_back(want[k].buyId); touched.push_back(want[k].sellId); }
+            for (int id : touched) {
+                QueuePosition pos;
+                if (!ref.findOrder(id) && book.queuePosition(id, pos) && pos.resting) {
+                    err << "watched order " << id << " still reported resting";
+                    break;
+                }
+            }
+        }
+
+        if (err.str().empty()) err << compareBooks(book, ref);
+        if (!err.str().empty()) {
+            f.eventIndex = i;
+            f.what = err.str();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Delta-debugging style shrink: drop chunks while the stream still fails
+std::vector<Event> shrink(std::vector<Event> events, bool plantBug) {
+    Failure f;
+    // Nothing after the first failing event matters
+    if (findMismatch(events, plantBug, f)) events.resize(f.eventIndex + 1);
+
+    for (size_t chunk = std::max<size_t>(1, events.size() / 2); ; chunk = std::max<size_t>(1, chunk / 2)) {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (size_t start = 0; start < events.size(); ) {
+                std::vector<Event> trial;
+                trial.reserve(events.size());
+                trial.insert(trial.end(), events.begin(), events.begin() + static_cast<std::ptrdiff_t>(start));
+                size_t end = std::min(events.size(), start + chunk);
+                trial.insert(trial.end(), events.begin() + static_cast<std::ptrdiff_t>(end), events.end());
+                if (!trial.empty() && findMismatch(trial, plantBug, f)) {
+                    trial.resize(f.eventIndex + 1);
+                    events.swap(trial);
+                    progress = true;
+                } else {
+                    start += chunk;
+                }
+            }
+        }
+        if (chunk == 1) break;
+    }
+    return events;
+}
+
+void report(const std::vector<Event>& minimal, bool plantBug, uint64_t seed, const std::string& reproOut) {
+    Failure f;
+    findMismatch(minimal, plantBug, f);
+    std::cerr << "MISMATCH (seed " << seed << ") shrunk to " << minimal.size() << " events; event #"
+              << f.eventIndex << ": " << f.what << "\n";
+    std::cerr << "# --- reproducer (orderbook_simulator input) ---\n";
+    for (size_t i = 0; i < minimal.size(); ++i) std::cerr << toLine(minimal[i], i) << "\n";
+    if (!reproOut.empty()) {
+        std::ofstream out(reproOut);
+        out << "# diff_fuzz reproducer, seed " << seed << ": " << f.what << "\n";
+        for (size_t i = 0; i < minimal.size(); ++i) out << toLine(minimal[i], i) << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    size_t cases = 300;
+    size_t events = 1500;
+    bool soak = false;
+    bool selfTest = false;
+    double seconds = 60;
+    std::string reproOut;
+    bool eventsSet = false;
+
+    bool ok = parseArgs(argc, argv, {"--soak", "--self-test"},
+        "[--seed N] [--cases N] [--events N] [--soak [--seconds N]] [--self-test] [--repro-out PATH]",
+        [&](const std::string& key, const std::string& val) {
+            if (key == "--soak")            soak = true;
+            else if (key == "--self-test")  selfTest = true;
+            else if (key == "--seed")       seed = std::stoull(val);
+            else if (key == "--cases")      cases = std::stoul(val);
+            else if (key == "--events")     { events = std::stoul(val); eventsSet = true; }
+            else if (key == "--seconds")    seconds = std::stod(val);
+            else if (key == "--repro-out")  reproOut = val;
+            else return false;
+            return true;
+        });
+    if (!ok) return 2;
+    if (soak && !eventsSet) events = 20000;
+
+    if (selfTest) {
+        // The reference is deliberately wrong; the harness must notice and shrink it
+        for (uint64_t c = 0; c < 50; ++c) {
+            auto stream = generateStream(seed + c, events);
+            Failure f;
+            if (!findMismatch(stream, true, f)) continue;
+            auto minimal = shrink(stream, true);
+            std::cout << "self-test: planted bug caught at event " << f.eventIndex << ", shrunk "
+                      << stream.size() << " -> " << minimal.size() << " events\n";
+            for (size_t i = 0; i < minimal.size(); ++i) std::cout << "  " << toLine(minimal[i], i) << "\n";
+            return minimal.size() <= 4 ? 0 : 1;
+        }
+        std::cerr << "self-test: planted bug was not detected\n";
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [&]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count(); };
+    double lastReport = 0;
+    size_t ran = 0, totalEvents = 0;
+
+    for (uint64_t c = 0; soak ? elapsed() < seconds : c < cases; ++c) {
+        uint64_t caseSeed = seed + c;
+        auto stream = generateStream(caseSeed, events);
+        Failure f;
+        if (findMismatch(stream, false, f)) {
+            report(shrink(stream, false), false, caseSeed, reproOut);
+            return 1;
+        }
+        ++ran;
+        totalEvents += stream.size();
+        if (soak && elapsed() - lastReport >= 10) {
+            lastReport = elapsed();
+            std::cout << "soak: " << ran << " cases, " << totalEvents << " events, "
+                      << static_cast<int>(lastReport) << "s\n" << std::flush;
+        }
+    }
+    std::cout << "diff_fuzz: " << ran << " cases, " << totalEvents << " events, no mismatches ("
+              << std::fixed << std::setprecision(1) << elapsed() << "s)\n";
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include "orderbook_impl.h" // custom listeners instantiate the engine themselves
+#include "test_support.h"
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Replays a random stream through BasicOrderBook<Recorder> and checks that the
+// event stream alone is enough to rebuild what the book reports:
+//   - FillEvents match trades() one for one
+//   - LevelChangedEvents rebuild the same depth as fillSnapshot()
+//   - the last TobChangedEvent matches the best bid/ask
+//   - every accepted order gets exactly one OrderDone iff it is not resting
+//   - reads from inside onFill see a consistent book (the operation that
+//     produced the fill has been fully applied)
+// A handler that submits orders from inside onFill exercises re-entrancy.
+// A handler that throws must leave the book usable for later calls.
+
+namespace {
+
+struct Recorder : NullListener {
+    BasicOrderBook<Recorder>* book{nullptr};
+    std::vector<FillEvent> fills;
+    std::map<std::pair<int, Price>, std::pair<int,int>> levels; // (side, px) -> (qty, orders)
+    TobChangedEvent tob{};
+    std::unordered_map<int, int> accepted;   // id -> done events seen
+    std::unordered_map<int, int> strayDone;  // done for ids never accepted
+    int  injectEvery{0};
+    int  nextInjectId{1000000};
+    bool inFill{false};
+    bool nested{false};
+    std::string readError; // first inconsistency seen from inside onFill
+
+    void onOrderAccepted(const OrderAcceptedEvent& e) { accepted.emplace(e.id, 0); }
+    void onOrderDone(const OrderDoneEvent& e) {
+        auto it = accepted.find(e.id);
+        if (it != accepted.end()) ++it->second;
+        else                      ++strayDone[e.id];
+    }
+    void onLevelChanged(const LevelChangedEvent& e) {
+        auto key = std::make_pair(static_cast<int>(e.side), e.priceTicks);
+        if (e.totalQty == 0) levels.erase(key);
+        else                 levels[key] = {e.totalQty, e.orders};
+    }
+    void onTobChanged(const TobChangedEvent& e) { tob = e; }
+    void onFill(const FillEvent& e) {
+        if (inFill) nested = true;
+        inFill = true;
+        fills.push_back(e);
+        if (readError.empty()) readError = checkReads(e);
+        // Chase the maker's side with a small IOC at the fill price
+        if (injectEvery > 0 && fills.size() % static_cast<size_t>(injectEvery) == 0) {
+            book->addOrder(Order(nextInjectId++, std::string(), e.takerSide, OrderType::LIMIT,
+                                 TimeInForce::IOC, e.priceTicks, 1));
+        }
+        inFill = false;
+    }
+
+    // The maker must already show its leaves qty, and top of book must agree with depth
+    std::string checkReads(const FillEvent& e) const {
+        if (book->restingQty(e.makerId) != e.makerLeavesQty) return "maker still resting after its fill";
+        BookSnapshot s;
+        book->fillSnapshot(s);
+        for (int k = 0; k < s.bidLevels; ++k) if (s.bids[k].qty <= 0 || s.bids[k].orders <= 0) return "empty bid level";
+        for (int k = 0; k < s.askLevels; ++k) if (s.asks[k].qty <= 0 || s.asks[k].orders <= 0) return "empty ask level";
+        if (s.bidLevels > 0 && (s.bestBidPx != s.bids[0].priceTicks || s.bestBidQty != s.bids[0].qty))
+            return "stale best bid";
+        if (s.askLevels > 0 && (s.bestAskPx != s.asks[0].priceTicks || s.bestAskQty != s.asks[0].qty))
+            return "stale best ask";
+        if (s.bidLevels > 0 && s.askLevels > 0 && s.bestBidPx >= s.bestAskPx) return "crossed book";
+        double bid, ask; int bidQty, askQty;
+        if (book->bestBidAsk(bid, bidQty, ask, askQty) && (bidQty != s.bestBidQty || askQty != s.bestAskQty))
+            return "bestBidAsk disagrees with depth";
+        return {};
+    }
+};
+
+int runCase(uint64_t seed, size_t events, int injectEvery) {
+    Recorder rec;
+    BasicOrderBook<Recorder> book(rec);
+    rec.book = &book;
+    rec.injectEvery = injectEvery;
+
+    int fails = 0;
+    auto fail = [&](const std::string& what) {
+        if (fails++ < 5) std::cerr << "seed " << seed << ": " << what << "\n";
+    };
+
+    StreamShape shape;
+    shape.band = 4;
+    shape.maxQty = 50;
+    shape.pCancel = 0.15;
+    for (const Event& e : generateStream(seed, events, shape)) apply(book, e);
+
+    if (rec.nested) fail("onFill re-entered: injected order ran inside a callback");
+    if (!rec.readError.empty()) fail("read from onFill: " + rec.readError);
+
+    const auto& trades = book.trades();
+    if (trades.size() != rec.fills.size()) {
+        fail("fills " + std::to_string(rec.fills.size()) + " vs trades " + std::to_string(trades.size()));
+    } else {
+        for (size_t k = 0; k < trades.size(); ++k) {
+            const FillEvent& f = rec.fills[k];
+            int buyId  = f.takerSide == OrderSide::BUY ? f.takerId : f.makerId;
+            int sellId = f.takerSide == OrderSide::BUY ? f.makerId : f.takerId;
+            if (trades[k].buyId != buyId || trades[k].sellId != sellId ||
+                trades[k].priceTicks != f.priceTicks || trades[k].quantity != f.qty) {
+                fail("fill " + std::to_string(k) + " disagrees with trades()");
+                break;
+            }
+        }
+    }
+
+    BookSnapshot s;
+    book.fillSnapshot(s);
+    int bidLevels = 0, askLevels = 0;
+    for (const auto& kv : rec.levels) (kv.first.first == static_cast<int>(OrderSide::BUY) ? bidLevels : askLevels)++;
+    if (bidLevels < s.bidLevels || askLevels < s.askLevels) fail("level events lost levels");
+    for (int k = 0; k < s.bidLevels + s.askLevels; ++k) {
+        bool bid = k < s.bidLevels;
+        const BookLevel& l = bid ? s.bids[k] : s.asks[k - s.bidLevels];
+        auto it = rec.levels.find({static_cast<int>(bid ? OrderSide::BUY : OrderSide::SELL), l.priceTicks});
+        if (it == rec.levels.end() || it->second != std::make_pair(l.qty, l.orders)) {
+            fail(std::string(bid ? "bid" : "ask") + " level " + std::to_string(l.priceTicks) + " disagrees");
+        }
+    }
+
+    const TobChangedEvent& t = rec.tob;
+    if (t.hasBid != (s.bidLevels > 0) || t.hasAsk != (s.askLevels > 0) ||
+        (t.hasBid && (t.bidPx != s.bestBidPx || t.bidQty != s.bestBidQty)) ||
+        (t.hasAsk && (t.askPx != s.bestAskPx || t.askQty != s.bestAskQty))) {
+        fail("last top-of-book event disagrees with the book");
+    }
+
+    if (!rec.strayDone.empty()) fail("OrderDone for an order that was never accepted");
+    for (const auto& kv : rec.accepted) {
+        bool resting = book.restingQty(kv.first) > 0;
+        if (kv.second != (resting ? 0 : 1)) {
+            fail("order " + std::to_string(kv.first) + " got " + std::to_string(kv.second) +
+                 " done events (resting=" + std::to_string(resting) + ")");
+        }
+    }
+    return fails;
+}
+
+// A hook that throws must not leave the book stuck in dispatch mode
+struct Thrower : NullListener {
+    BasicOrderBook<Thrower>* book{nullptr};
+    bool armed{true};
+    void onFill(const FillEvent&) {
+        if (!armed) return;
+        armed = false;
+        book->addOrder(Order(99, std::string(), OrderSide::BUY, OrderType::LIMIT, TimeInForce::GTC, 90, 1));
+        throw std::runtime_error("hook failed");
+    }
+};
+
+int runThrowCase() {
+    Thrower t;
+    BasicOrderBook<Thrower> book(t);
+    t.book = &book;
+    auto lim = [](int id, OrderSide side, Price px, int qty) {
+        return Order(id, std::string(), side, OrderType::LIMIT, TimeInForce::GTC, px, qty);
+    };
+    book.addOrder(lim(1, OrderSide::SELL, 100, 5));
+    bool threw = false;
+    try { book.addOrder(lim(2, OrderSide::BUY, 100, 5)); }
+    catch (const std::runtime_error&) { threw = true; }
+    int fails = 0;
+    if (!threw) { ++fails; std::cerr << "throwing hook: exception did not propagate\n"; }
+    if (book.restingQty(99) != 0) { ++fails; std::cerr << "throwing hook: its queued call still ran\n"; }
+    book.addOrder(lim(3, OrderSide::BUY, 95, 4));
+    if (book.restingQty(3) != 4) { ++fails; std::cerr << "throwing hook: later addOrder was swallowed\n"; }
+    return fails;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t seed = 1;
+    int cases = 50;
+    size_t events = 5000;
+
+    bool parsed = parseArgs(argc, argv, {}, "[--seed N] [--cases N] [--events N]",
+        [&](const std::string& key, const std::string& val) {
+            if (key == "--seed")        seed = std::stoull(val);
+            else if (key == "--cases")  cases = std::stoi(val);
+            else if (key == "--events") events = std::stoul(val);
+            else return false;
+            return true;
+        });
+    if (!parsed) return 2;
+
+    int failed = 0;
+    if (runThrowCase() != 0) ++failed;
+    for (int c = 0; c < cases; ++c) {
+        // Alternate plain runs with runs that submit orders from inside onFill
+        if (runCase(seed + static_cast<uint64_t>(c), events, (c % 2) ? 7 : 0) != 0) ++failed;
+    }
+    std::cout << cases << " cases x " << events << " events: " << (failed ? "FAIL" : "OK")
+              << " (" << failed << " failed)\n";
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#include "orderbook.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Scripted check of the queue-position callback: the exact sequence of
+// positions reported for a watched order as the front of its queue fills, an
+// order ahead is cancelled, an order ahead is modified (and so re-queues behind
+// it), and finally as the watched order itself fills and leaves the book.
+// Duplicate ids (the simulator accepts id= from input) must not leave a
+// watch linked into a level after it is freed: run under ASan in Debug.
+
+namespace {
+
+struct Seen {
+    int  id;
+    bool resting;
+    int  qtyAhead;
+    int  rank;
+    int  remainingQty;
+};
+
+int failures = 0;
+
+void expect(const std::string& step, const std::vector<Seen>& got, const std::vector<Seen>& want) {
+    bool ok = got.size() == want.size();
+    for (size_t i = 0; ok && i < got.size(); ++i) {
+        ok = got[i].id == want[i].id && got[i].resting == want[i].resting && got[i].qtyAhead == want[i].qtyAhead &&
+             got[i].rank == want[i].rank && got[i].remainingQty == want[i].remainingQty;
+    }
+    if (ok) return;
+    ++failures;
+    auto dump = [](const std::vector<Seen>& v) {
+        std::string s;
+        for (const auto& e : v) {
+            s += " {#" + std::to_string(e.id) + " resting=" + std::to_string(e.resting) + " ahead=" +
+                 std::to_string(e.qtyAhead) + " rank=" + std::to_string(e.rank) + " qty=" +
+                 std::to_string(e.remainingQty) + "}";
+        }
+        return s.empty() ? std::string(" (none)") : s;
+    };
+    std::cerr << "FAIL " << step << "\n  got: " << dump(got) << "\n  want:" << dump(want) << "\n";
+}
+
+Order limit(int id, OrderSide side, Price px, int qty) {
+    return Order(id, std::string(), side, OrderType::LIMIT, TimeInForce::GTC, px, qty);
+}
+
+} // namespace
+
+int main() {
+    OrderBook book;
+    std::vector<Seen> seen;
+    auto record = [&](int id, const QueuePosition& p) {
+        seen.push_back(Seen{id, p.resting, p.qtyAhead, p.rank, p.remainingQty});
+    };
+    book.setQueuePositionCallback(record);
+    auto step = [&](const std::string& name, const std::vector<Seen>& want) {
+        expect(name, seen, want);
+        seen.clear();
+    };
+
+    // Four sells ahead of watched order #5 at 100 (watched before it arrives)
+    book.addOrder(limit(1, OrderSide::SELL, 100, 10));
+    book.addOrder(limit(2, OrderSide::SELL, 100, 20));
+    book.addOrder(limit(3, OrderSide::SELL, 100, 30));
+    book.addOrder(limit(4, OrderSide::SELL, 100, 5));
+    book.watchOrder(5);
+    book.addOrder(limit(5, OrderSide::SELL, 100, 7));
+    step("rest behind 4 orders", {{5, true, 65, 4, 7}});
+
+    book.addOrder(limit(10, OrderSide::BUY, 100, 4));
+    step("partial fill at the front", {{5, true, 61, 4, 7}});
+    book.addOrder(limit(11, OrderSide::BUY, 100, 6));
+    step("front order filled", {{5, true, 55, 3, 7}});
+
+    book.cancelOrder(3);
+    step("cancel ahead", {{5, true, 25, 2, 7}});
+
+    book.modifyOrder(2, 100, 20);
+    step("modify ahead loses priority", {{5, true, 5, 1, 7}});
+
+    book.addOrder(limit(12, OrderSide::BUY, 100, 8));
+    step("fill through to the watched order", {{5, true, 0, 0, 7}, {5, true, 0, 0, 4}});
+
+    book.cancelOrder(5);
+    step("watched order cancelled", {{5, false, 0, 0, 0}});
+    QueuePosition pos;
+    if (book.queuePosition(5, pos)) { ++failures; std::cerr << "FAIL watch on #5 kept after cancel\n"; }
+
+    // Watch an order already resting, then fill it completely
+    book.addOrder(limit(20, OrderSide::BUY, 99, 10));
+    book.watchOrder(20);
+    step("watch a resting order", {{20, true, 0, 0, 10}});
+    book.addOrder(Order(21, std::string(), OrderSide::SELL, OrderType::MARKET, TimeInForce::GTC, 0, 10));
+    step("watched order filled", {{20, false, 0, 0, 0}});
+    if (book.queuePosition(20, pos)) { ++failures; std::cerr << "FAIL watch on #20 kept after fill\n"; }
+
+    // Duplicate ids. A non-resting order reusing a watched id leaves the watch alone
+    OrderBook dup;
+    dup.setQueuePositionCallback(record);
+    dup.addOrder(limit(1, OrderSide::SELL, 100, 5));
+    dup.watchOrder(1);
+    step("dup: watch resting #1", {{1, true, 0, 0, 5}});
+    dup.addOrder(Order(1, std::string(), OrderSide::BUY, OrderType::LIMIT, TimeInForce::IOC, 90, 3));
+    step("dup: IOC reusing #1 does not rest", {});
+    dup.addOrder(limit(2, OrderSide::BUY, 100, 5));
+    step("dup: original #1 filled", {{1, false, 0, 0, 0}});
+
+    // A second resting #30 at another price: the watch follows the newest one
+    dup.addOrder(limit(30, OrderSide::SELL, 101, 5));
+    dup.watchOrder(30);
+    dup.addOrder(limit(30, OrderSide::SELL, 102, 4));
+    step("dup: #30 rests again elsewhere", {{30, true, 0, 0, 5}, {30, true, 0, 0, 4}});
+    dup.addOrder(limit(31, OrderSide::BUY, 101, 5));
+    step("dup: older #30 filled", {});
+    dup.addOrder(limit(32, OrderSide::BUY, 102, 4));
+    step("dup: newer #30 filled", {{30, false, 0, 0, 0}});
+
+    // Same level: the older #40 at the front is ahead of the watched (newer) one
+    dup.addOrder(limit(40, OrderSide::SELL, 100, 3));
+    dup.watchOrder(40);
+    dup.addOrder(limit(40, OrderSide::SELL, 100, 2));
+    step("dup: #40 rests again behind itself", {{40, true, 0, 0, 3}, {40, true, 3, 1, 2}});
+    dup.addOrder(limit(41, OrderSide::BUY, 100, 3));
+    step("dup: older #40 filled", {{40, true, 0, 0, 2}});
+    dup.addOrder(limit(42, OrderSide::BUY, 100, 2));
+    step("dup: newer #40 filled", {{40, false, 0, 0, 0}});
+    for (int id : {1, 30, 40}) {
+        if (dup.queuePosition(id, pos)) { ++failures; std::cerr << "FAIL watch on #" << id << " kept after fill\n"; }
+    }
+
+    std::cout << "queue_position: " << (failures ? "FAIL" : "OK") << "\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+#ifndef REFERENCE_MATCHER_H
+#define REFERENCE_MATCHER_H
+
+#include "order.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Deliberately naive price-time matcher used as the oracle for diff_fuzz.
+// Resting orders live in one flat vector; every decision is a linear scan, so
+// the rules below are easy to audit against OrderBook's:
+//   - best price first, then earliest arrival (price-time priority)
+//   - trades print at the resting (maker) price
+//   - MARKET never rests; IOC/FOK never rest; FOK trades only if fully fillable
+//   - MODIFY loses priority, re-matches at the new price, rests any remainder
+//   - MODIFY with qty <= 0 is a cancel
+class ReferenceMatcher {
+public:
+    struct Resting {
+        int       id;
+        OrderSide side;
+        Price     px;
+        int       qty;
+        uint64_t  seq;
+    };
+    struct Fill {
+        Price px;
+        int   qty;
+        int   buyId;
+        int   sellId;
+    };
+    struct Level {
+        int qty{0};
+        int orders{0};
+    };
+
+    // Harness self-test hook: print trades at the taker's limit instead of the maker price
+    bool bugTakerPrice{false};
+
+    void add(const Order& in) {
+        Order o = in;
+        if (o.tif == TimeInForce::FOK && available(o) < o.quantity) return;
+        match(o);
+        if (o.type == OrderType::LIMIT && o.quantity > 0 &&
+            o.tif != TimeInForce::IOC && o.tif != TimeInForce::FOK) {
+            rest(o);
+        }
+    }
+
+    bool cancel(int id) {
+        auto it = find(id);
+        if (it == orders_.end()) return false;
+        orders_.erase(it);
+        return true;
+    }
+
+    bool modify(int id, Price px, int qty) {
+        if (qty <= 0) return cancel(id);
+        auto it = find(id);
+        if (it == orders_.end()) return false;
+        Order o(it->id, std::string(), it->side, OrderType::LIMIT, TimeInForce::GTC, px, qty);
+        orders_.erase(it);
+        match(o);
+        if (o.quantity > 0) rest(o);
+        return true;
+    }
+
+    const std::vector<Fill>&    fills() const { return fills_; }
+    const std::vector<Resting>& orders() const { return orders_; }
+
+    const Resting* findOrder(int id) const {
+        for (const auto& r : orders_) if (r.id == id) return &r;
+        return nullptr;
+    }
+
+    // Quantity / order count ahead of each resting order at its level (arrival order)
+    std::vector<std::pair<int,int>> queueAhead() const {
+        std::map<std::pair<int, Price>, std::pair<int,int>> running; // (side, px) -> (qty, orders)
+        std::vector<std::pair<int,int>> out;
+        out.reserve(orders_.size());
+        for (const auto& o : orders_) {
+            auto& lv = running[{static_cast<int>(o.side), o.px}];
+            out.push_back(lv);
+            lv.first += o.qty;
+            lv.second += 1;
+        }
+        return out;
+    }
+
+    // Aggregated levels, best first
+    std::vector<std::pair<Price, Level>> levels(OrderSide side) const {
+        std::map<Price, Level> agg;
+        for (const auto& o : orders_) {
+            if (o.side != side) continue;
+            agg[o.px].qty += o.qty;
+            agg[o.px].orders += 1;
+        }
+        std::vector<std::pair<Price, Level>> out(agg.begin(), agg.end());
+        if (side == OrderSide::BUY) std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+private:
+    std::vector<Resting> orders_; // arrival order
+    std::vector<Fill>    fills_;
+    uint64_t             nextSeq_{0};
+
+    std::vector<Resting>::iterator find(int id) {
+        return std::find_if(orders_.begin(), orders_.end(), [&](const Resting& r) { return r.id == id; });
+    }
+
+    bool crosses(const Order& o, Price makerPx) const {
+        if (o.type == OrderType::MARKET) return true;
+        return o.side == OrderSide::BUY ? makerPx <= o.priceTicks : makerPx >= o.priceTicks;
+    }
+
+    int available(const Order& o) const {
+        int total = 0;
+        for (const auto& r : orders_) {
+            if (r.side != o.side && crosses(o, r.px)) total += r.qty;
+        }
+        return total;
+    }
+
+    // Index of the best resting order on the opposite side that `o` can trade with, or -1
+    long bestMaker(const Order& o) const {
+        long best = -1;
+        for (size_t i = 0; i < orders_.size(); ++i) {
+            const Resting& r = orders_[i];
+            if (r.side == o.side || !crosses(o, r.px)) continue;
+            if (best < 0) { best = static_cast<long>(i); continue; }
+            const Resting& b = orders_[static_cast<size_t>(best)];
+            bool better = (o.side == OrderSide::BUY) ? r.px < b.px : r.px > b.px;
+            if (better || (r.px == b.px && r.seq < b.seq)) best = static_cast<long>(i);
+        }
+        return best;
+    }
+
+    void match(Order& o) {
+        while (o.quantity > 0) {
+            long i = bestMaker(o);
+            if (i < 0) break;
+            Resting& m = orders_[static_cast<size_t>(i)];
+            int q = std::min(o.quantity, m.qty);
+            Price px = (bugTakerPrice && o.type == OrderType::LIMIT) ? o.priceTicks : m.px;
+            if (o.side == OrderSide::BUY) fills_.push_back(Fill{px, q, o.id, m.id});
+            else                          fills_.push_back(Fill{px, q, m.id, o.id});
+            o.quantity -= q;
+            m.qty -= q;
+            if (m.qty == 0) orders_.erase(orders_.begin() + i);
+        }
+    }
+
+    void rest(const Order& o) {
+        orders_.push_back(Resting{o.id, o.side, o.priceTicks, o.quantity, nextSeq_++});
+    }
+};
+
+#endif // REFERENCE_MATCHER_H
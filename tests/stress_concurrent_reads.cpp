@@ -0,0 +1,212 @@
+#include "orderbook.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Stress test for OrderBook concurrent reads: reader threads (pinned to
+// separate cores where possible) hammer readSnapshot() while the main thread
+// replays a synthetic stream at full speed.
+//
+// Phase 1 (per-event publishing): every snapshot must satisfy book invariants.
+// Phase 2 (batch publishing): every snapshot must match, bit for bit, the state
+// the matcher recorded for that eventSeq before publishing it.
+// Both phases also require readers to have seen a meaningful share of the
+// published versions, i.e. to have actually run alongside the matcher. With
+// fewer than 2 usable CPUs that cannot happen, so the test is skipped.
+
+namespace {
+
+uint64_t hashSnapshot(const BookSnapshot& s) {
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&](int64_t v) { h ^= static_cast<uint64_t>(v); h *= 1099511628211ULL; };
+    mix(static_cast<int64_t>(s.eventSeq));
+    mix(s.bidLevels); mix(s.askLevels);
+    if (s.bidLevels > 0) { mix(s.bestBidPx); mix(s.bestBidQty); }
+    if (s.askLevels > 0) { mix(s.bestAskPx); mix(s.bestAskQty); }
+    for (int i = 0; i < s.bidLevels; ++i) { mix(s.bids[i].priceTicks); mix(s.bids[i].qty); mix(s.bids[i].orders); }
+    for (int i = 0; i < s.askLevels; ++i) { mix(s.asks[i].priceTicks); mix(s.asks[i].qty); mix(s.asks[i].orders); }
+    return h;
+}
+
+// Empty string if the snapshot is internally consistent
+std::string checkInvariants(const BookSnapshot& s) {
+    if (s.bidLevels < 0 || s.bidLevels > kSnapshotDepth) return "bidLevels out of range";
+    if (s.askLevels < 0 || s.askLevels > kSnapshotDepth) return "askLevels out of range";
+    for (int i = 0; i < s.bidLevels; ++i) {
+        const BookLevel& l = s.bids[i];
+        if (l.qty <= 0 || l.orders <= 0 || l.qty < l.orders) return "bad bid level qty/orders";
+        if (i > 0 && l.priceTicks >= s.bids[i-1].priceTicks) return "bids not strictly descending";
+    }
+    for (int i = 0; i < s.askLevels; ++i) {
+        const BookLevel& l = s.asks[i];
+        if (l.qty <= 0 || l.orders <= 0 || l.qty < l.orders) return "bad ask level qty/orders";
+        if (i > 0 && l.priceTicks <= s.asks[i-1].priceTicks) return "asks not strictly ascending";
+    }
+    if (s.bidLevels > 0 && (s.bestBidPx != s.bids[0].priceTicks || s.bestBidQty != s.bids[0].qty))
+        return "best bid disagrees with depth";
+    if (s.askLevels > 0 && (s.bestAskPx != s.asks[0].priceTicks || s.bestAskQty != s.asks[0].qty))
+        return "best ask disagrees with depth";
+    if (s.bidLevels > 0 && s.askLevels > 0 && s.bestBidPx >= s.bestAskPx) return "crossed book";
+    return {};
+}
+
+unsigned usableCpus() {
+#if defined(__linux__)
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) return static_cast<unsigned>(CPU_COUNT(&set));
+#endif
+    return std::thread::hardware_concurrency(); // 0 if unknown
+}
+
+void pinToCore(std::thread& t, unsigned core) {
+#if defined(__linux__)
+    unsigned n = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % n, &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t; (void)core;
+#endif
+}
+
+struct PhaseResult {
+    double   writerEventsPerSec{0};
+    uint64_t reads{0};
+    uint64_t distinct{0};
+    uint64_t published{0};
+    bool     ok{true};
+};
+
+PhaseResult runPhase(const std::vector<Event>& stream, int readers, size_t batch) {
+    const bool perEvent = (batch == 0);
+    OrderBook book;
+
+    // Phase 2 bookkeeping: hash of the state published at each eventSeq. Written
+    // before the publish (release) that makes that eventSeq visible to readers.
+    std::vector<uint64_t> expected(perEvent ? 0 : stream.size() + 1, 0);
+    if (!perEvent) {
+        BookSnapshot s;
+        book.fillSnapshot(s);
+        expected[s.eventSeq] = hashSnapshot(s);
+    }
+    book.enableConcurrentReads(perEvent);
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> totalReads{0}, totalDistinct{0};
+    std::atomic<bool> ok{true};
+    std::mutex errMu;
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&]() {
+            uint64_t reads = 0, distinct = 0, lastSeq = 0, lastVersion = 0;
+            BookSnapshot s;
+            while (!done.load(std::memory_order_relaxed)) {
+                uint64_t v = book.snapshotVersion();
+                if (!book.readSnapshot(s)) continue;
+                ++reads;
+                if (v != lastVersion) { ++distinct; lastVersion = v; }
+
+                std::string err = checkInvariants(s);
+                if (err.empty() && s.eventSeq < lastSeq) err = "eventSeq went backwards";
+                if (err.empty() && !perEvent && expected[s.eventSeq] != hashSnapshot(s)) err = "torn or stale snapshot";
+                lastSeq = s.eventSeq;
+                if (!err.empty()) {
+                    std::lock_guard<std::mutex> lk(errMu);
+                    if (ok.exchange(false)) std::cerr << "FAIL at eventSeq " << s.eventSeq << ": " << err << "\n";
+                    break;
+                }
+            }
+            totalReads += reads;
+            totalDistinct += distinct;
+        });
+        pinToCore(threads.back(), static_cast<unsigned>(r + 1));
+    }
+
+    uint64_t lastSeq = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < stream.size(); ++i) {
+        apply(book, stream[i]);
+        if (!perEvent && ((i + 1) % batch == 0 || i + 1 == stream.size())) {
+            BookSnapshot s;
+            book.fillSnapshot(s);
+            // Same eventSeq means nothing changed and the slot already has this state
+            if (s.eventSeq != lastSeq) expected[s.eventSeq] = hashSnapshot(s);
+            lastSeq = s.eventSeq;
+            book.publishSnapshot();
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    done = true;
+    for (auto& t : threads) t.join();
+
+    PhaseResult res;
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    res.writerEventsPerSec = secs > 0 ? static_cast<double>(stream.size()) / secs : 0;
+    res.reads = totalReads;
+    res.distinct = totalDistinct;
+    res.published = book.snapshotVersion() / 2; // seqlock version moves by 2 per publish
+    res.ok = ok;
+    return res;
+}
+
+constexpr int kSkip = 77; // SKIP_RETURN_CODE in CMakeLists.txt
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t events = 1000000;
+    int readers = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    uint64_t seed = 42;
+    size_t batch = 16;
+
+    bool parsed = parseArgs(argc, argv, {}, "[--events N] [--readers N] [--seed N] [--batch N]",
+        [&](const std::string& key, const std::string& val) {
+            if (key == "--events")       events = std::stoul(val);
+            else if (key == "--readers") readers = std::stoi(val);
+            else if (key == "--seed")    seed = std::stoull(val);
+            else if (key == "--batch")   batch = std::max<size_t>(1, std::stoul(val));
+            else return false;
+            return true;
+        });
+    if (!parsed) return 2;
+
+    unsigned cpus = usableCpus();
+    if (cpus == 1) {
+        std::cout << "SKIP: 1 usable CPU, readers cannot run concurrently with the matcher\n";
+        return kSkip;
+    }
+
+    auto stream = generateStream(seed, events, StreamShape{});
+    std::cout << "Replaying " << events << " events with " << readers << " reader threads\n";
+
+    bool ok = true;
+    for (size_t b : {size_t{0}, batch}) {
+        PhaseResult r = runPhase(stream, readers, b);
+        // Readers that mostly slept through the run prove nothing about torn reads
+        if (r.ok && r.distinct < std::max<uint64_t>(1, r.published / 100)) {
+            std::cerr << "FAIL: readers saw only " << r.distinct << " of " << r.published << " published versions\n";
+            r.ok = false;
+        }
+        std::cout << (b == 0 ? "per-event" : "batch") << (b ? "(" + std::to_string(b) + ")" : std::string())
+                  << ": matcher " << static_cast<uint64_t>(r.writerEventsPerSec) << " events/s, "
+                  << r.reads << " reads (" << r.distinct << " of " << r.published << " versions) -> "
+                  << (r.ok ? "OK" : "FAIL") << "\n";
+        ok = ok && r.ok;
+    }
+    return ok ? 0 : 1;
+}
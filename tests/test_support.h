@@ -0,0 +1,128 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include "order.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Shared by the test drivers: the synthetic event type, a seeded stream
+// generator, replay onto any book type, and "--key value" argument parsing.
+
+struct Event {
+    enum Kind : uint8_t { Add, Cancel, Modify } kind{Add};
+    Order order;        // Add
+    int   targetId{0};  // Cancel / Modify
+    Price pxTicks{0};   // Modify
+    int   qty{0};       // Modify (<= 0 cancels)
+};
+
+// Shape of a generated stream; prices are mid +/- band ticks around 10000
+struct StreamShape {
+    int    band{3};
+    int    maxQty{200};
+    double pCancel{0.10};
+    double pModify{0.08};
+    double pMarket{0.02};
+};
+
+namespace test_support_detail {
+inline std::vector<Event> generate(std::mt19937_64& rng, size_t n, const StreamShape& shape) {
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    const Price mid = 10000;
+
+    std::vector<Event> out;
+    out.reserve(n);
+    int nextId = 1;
+    for (size_t i = 0; i < n; ++i) {
+        Event e;
+        double r = u01(rng);
+        // Targets are mostly recent ids; some are unknown or already gone
+        auto target = [&]() {
+            if (nextId == 1 || u01(rng) < 0.1) return pick(1, nextId + 5);
+            return pick(std::max(1, nextId - 200), nextId - 1);
+        };
+        if (r < shape.pCancel) {
+            e.kind = Event::Cancel;
+            e.targetId = target();
+        } else if (r < shape.pCancel + shape.pModify) {
+            e.kind = Event::Modify;
+            e.targetId = target();
+            e.pxTicks = mid + pick(-shape.band, shape.band);
+            e.qty = u01(rng) < 0.05 ? 0 : pick(1, shape.maxQty);
+        } else {
+            OrderSide side = u01(rng) < 0.5 ? OrderSide::BUY : OrderSide::SELL;
+            OrderType type = u01(rng) < shape.pMarket ? OrderType::MARKET : OrderType::LIMIT;
+            double t = u01(rng);
+            TimeInForce tif = t < 0.08 ? TimeInForce::IOC : t < 0.14 ? TimeInForce::FOK
+                            : t < 0.20 ? TimeInForce::DAY : TimeInForce::GTC;
+            int qty = u01(rng) < 0.01 ? 0 : pick(1, shape.maxQty);
+            e.order = Order(nextId++, std::string(), side, type, tif, mid + pick(-shape.band, shape.band), qty);
+        }
+        out.push_back(e);
+    }
+    return out;
+}
+} // namespace test_support_detail
+
+// Add/cancel/modify/market/IOC/FOK/DAY stream with a fixed shape
+inline std::vector<Event> generateStream(uint64_t seed, size_t n, const StreamShape& shape) {
+    std::mt19937_64 rng(seed);
+    return test_support_detail::generate(rng, n, shape);
+}
+
+// As above, but each seed also picks its own shape so cases differ in depth and churn
+inline std::vector<Event> generateStream(uint64_t seed, size_t n) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> u01(0.0, 1.0);
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    StreamShape shape;
+    shape.band    = pick(1, 8);
+    shape.maxQty  = pick(1, 4) == 1 ? 5 : 200;
+    shape.pCancel = 0.05 + 0.15 * u01(rng);
+    shape.pModify = 0.05 + 0.10 * u01(rng);
+    shape.pMarket = 0.03 * u01(rng);
+    return test_support_detail::generate(rng, n, shape);
+}
+
+// Replays one event; returns the book's result
+template<class Book>
+bool apply(Book& book, const Event& e) {
+    switch (e.kind) {
+        case Event::Add:    return book.addOrder(e.order);
+        case Event::Cancel: return book.cancelOrder(e.targetId);
+        case Event::Modify: return book.modifyOrder(e.targetId, e.pxTicks, e.qty);
+    }
+    return false;
+}
+
+// Parses "--key value" / "--key=value"; keys in `flags` take no value. `onOption`
+// returns false for an unknown key and may throw on a bad value. Prints usage or
+// the offending value and returns false on error.
+inline bool parseArgs(int argc, char* argv[], std::initializer_list<const char*> flags, const char* usage,
+                      const std::function<bool(const std::string& key, const std::string& val)>& onOption) {
+    for (int i = 1; i < argc; ++i) {
+        std::string s(argv[i]);
+        bool isFlag = std::any_of(flags.begin(), flags.end(), [&](const char* f) { return s == f; });
+        auto eq = s.find('=');
+        std::string key = isFlag ? s : s.substr(0, eq);
+        std::string val = isFlag ? std::string()
+                        : (eq != std::string::npos) ? s.substr(eq + 1) : (i + 1 < argc ? argv[++i] : "");
+        bool known = false;
+        try { known = onOption(key, val); }
+        catch (...) { std::cerr << "Invalid value for " << key << ": " << val << "\n"; return false; }
+        if (!known) {
+            std::cerr << "Usage: " << argv[0] << " " << usage << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // TEST_SUPPORT_H